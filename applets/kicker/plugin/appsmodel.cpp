@@ -23,13 +23,18 @@
 #include "rootmodel.h"
 
 #include <QCollator>
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QFutureWatcher>
 #include <QQmlPropertyMap>
 #include <QTimer>
+#include <QtConcurrentRun>
 
 #include <KLocalizedString>
 #include <KSycoca>
 
+#include <functional>
+
 AppsModel::AppsModel(const QString &entryPath, bool paginate, int pageSize, bool flat,
     bool sorted, bool separators, QObject *parent)
 : AbstractModel(parent)
@@ -46,6 +51,8 @@ AppsModel::AppsModel(const QString &entryPath, bool paginate, int pageSize, bool
 , m_entryPath(entryPath)
 , m_staticEntryList(false)
 , m_changeTimer(nullptr)
+, m_menuSignatureWatcher(nullptr)
+, m_menuCheckPending(false)
 , m_flat(flat)
 , m_sorted(sorted)
 , m_appNameFormat(AppEntry::NameOnly)
@@ -70,6 +77,8 @@ AppsModel::AppsModel(const QList<AbstractEntry *> entryList, bool deleteEntriesO
 , m_entryPath(QString())
 , m_staticEntryList(true)
 , m_changeTimer(nullptr)
+, m_menuSignatureWatcher(nullptr)
+, m_menuCheckPending(false)
 , m_flat(true)
 , m_sorted(true)
 , m_appNameFormat(AppEntry::NameOnly)
@@ -94,6 +103,72 @@ AppsModel::AppsModel(const QList<AbstractEntry *> entryList, bool deleteEntriesO
     sortEntries();
 }
 
+// Hashes everything the entries of the menu tree show or use.
+// Runs in a worker thread, which gets its own KSycoca instance.
+static QByteArray menuSignature()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    auto addString = [&hash](const QString &string) {
+        hash.addData(string.toUtf8());
+        hash.addData("\0", 1);
+    };
+
+    std::function<void(const KServiceGroup::Ptr &)> processGroup = [&](const KServiceGroup::Ptr &group) {
+        if (!group || !group->isValid()) {
+            return;
+        }
+
+        const KServiceGroup::List list = group->entries(true /* sorted */, true /* excludeNoDisplay */,
+            true /* allowSeparators */, false /* sortByGenericName */);
+
+        for (KServiceGroup::List::ConstIterator it = list.constBegin(); it != list.constEnd(); it++) {
+            const KSycocaEntry::Ptr p = (*it);
+
+            if (p->isType(KST_KServiceGroup)) {
+                const KServiceGroup::Ptr subGroup(static_cast<KServiceGroup*>(p.data()));
+
+                addString(QStringLiteral("group"));
+                addString(subGroup->entryPath());
+                addString(subGroup->caption());
+                addString(subGroup->icon());
+                addString(QString::number(subGroup->childCount()));
+                addString(QString::number(subGroup->noDisplay()));
+
+                processGroup(subGroup);
+            } else if (p->isType(KST_KService)) {
+                const KService::Ptr service(static_cast<KService*>(p.data()));
+
+                addString(QStringLiteral("service"));
+                addString(service->storageId());
+                addString(service->menuId());
+                addString(service->entryPath());
+                addString(service->name());
+                addString(service->genericName());
+                // AppEntry describes the application with it when there is no generic name
+                addString(service->comment());
+                addString(service->icon());
+                addString(service->exec());
+                addString(QString::number(service->noDisplay()));
+                addString(QString::number(service->isApplication()));
+
+                foreach (const KServiceAction &action, service->actions()) {
+                    addString(action.name());
+                    addString(action.text());
+                    addString(action.icon());
+                    addString(action.exec());
+                }
+            } else if (p->isType(KST_KServiceSeparator)) {
+                addString(QStringLiteral("separator"));
+            }
+        }
+    };
+
+    processGroup(KServiceGroup::root());
+
+    return hash.result();
+}
+
 AppsModel::~AppsModel()
 {
     if (m_deleteEntriesOnDestruction) {
@@ -557,12 +632,17 @@ void AppsModel::refreshInternal()
             sortEntries();
         }
 
-        m_changeTimer = new QTimer(this);
-        m_changeTimer->setSingleShot(true);
-        m_changeTimer->setInterval(100);
-        connect(m_changeTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+        if (!m_changeTimer) {
+            m_changeTimer = new QTimer(this);
+            m_changeTimer->setSingleShot(true);
+            m_changeTimer->setInterval(100);
+            connect(m_changeTimer, SIGNAL(timeout()), this, SLOT(checkMenuChanged()));
 
-        connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), SLOT(checkSycocaChanges(QStringList)));
+            connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), SLOT(checkSycocaChanges(QStringList)));
+
+            // Fingerprint the tree we just built, so the first change can be skipped too
+            computeMenuSignature(true);
+        }
     } else {
         KServiceGroup::Ptr group = KServiceGroup::group(m_entryPath);
         processServiceGroup(group);
@@ -719,10 +799,55 @@ void AppsModel::sortEntries()
 void AppsModel::checkSycocaChanges(const QStringList &changes)
 {
     if (changes.contains(QLatin1String("services")) || changes.contains(QLatin1String("apps")) || changes.contains(QLatin1String("xdgdata-apps"))) {
+        if (m_menuSignatureWatcher) {
+            m_menuCheckPending = true;
+        }
+
         m_changeTimer->start();
     }
 }
 
+void AppsModel::checkMenuChanged()
+{
+    computeMenuSignature(false);
+}
+
+void AppsModel::computeMenuSignature(bool initial)
+{
+    if (m_menuSignatureWatcher) {
+        m_menuCheckPending = true;
+        return;
+    }
+
+    m_menuSignatureWatcher = new QFutureWatcher<QByteArray>(this);
+
+    connect(m_menuSignatureWatcher, &QFutureWatcher<QByteArray>::finished, this, [this, initial]() {
+        const QByteArray signature = m_menuSignatureWatcher->result();
+
+        m_menuSignatureWatcher->deleteLater();
+        m_menuSignatureWatcher = nullptr;
+
+        if (initial) {
+            // A change that came in while hashing may already be part of the signature,
+            // keep none so that the pending check rebuilds
+            if (!m_menuCheckPending) {
+                m_menuSignature = signature;
+            }
+        } else if (m_menuSignature.isEmpty() || signature != m_menuSignature) {
+            // Installing packages without applications, mime types or plugins stops here
+            m_menuSignature = signature;
+            refresh();
+        }
+
+        if (m_menuCheckPending) {
+            m_menuCheckPending = false;
+            checkMenuChanged();
+        }
+    });
+
+    m_menuSignatureWatcher->setFuture(QtConcurrent::run(menuSignature));
+}
+
 void AppsModel::entryChanged(AbstractEntry *entry)
 {
     int i = m_entryList.indexOf(entry);
@@ -31,6 +31,9 @@
 
 class QTimer;
 
+template<typename T>
+class QFutureWatcher;
+
 class AppsModel : public AbstractModel, public QQmlParserStatus
 {
     Q_OBJECT
@@ -137,8 +140,10 @@ class AppsModel : public AbstractModel, public QQmlParserStatus
 
     private Q_SLOTS:
         void checkSycocaChanges(const QStringList &changes);
+        void checkMenuChanged();
 
     private:
+        void computeMenuSignature(bool initial);
         void processServiceGroup(KServiceGroup::Ptr group);
         void sortEntries();
 
@@ -148,6 +153,11 @@ class AppsModel : public AbstractModel, public QQmlParserStatus
         QString m_entryPath;
         bool m_staticEntryList;
         QTimer *m_changeTimer;
+        // Fingerprint of the menu tree, computed off the GUI thread to skip rebuilds
+        // when a sycoca change does not touch the application menu
+        QByteArray m_menuSignature;
+        QFutureWatcher<QByteArray> *m_menuSignatureWatcher;
+        bool m_menuCheckPending;
         bool m_flat;
         bool m_sorted;
         AppEntry::NameFormat m_appNameFormat;
@@ -24,6 +24,7 @@
 #include "fileentry.h"
 #include "actionlist.h"
 #include "debug.h"
+#include "kastatsquerycache.h"
 
 #include <QFileInfo>
 #include <QTimer>
@@ -37,7 +38,6 @@
 #include <KActivities/Stats/Terms>
 #include <KActivities/Stats/Query>
 #include <KActivities/Stats/ResultSet>
-#include <KActivities/Stats/ResultWatcher>
 
 namespace KAStats = KActivities::Stats;
 
@@ -190,17 +190,17 @@ public:
                   | Activity::global()
                   | Limit::all()
               )
-        , m_watcher(m_query)
+        , m_results(KAStatsQueryCache::linkedResults(m_query))
         , m_clientId(clientId)
     {
-        // Connecting the watcher
-        connect(&m_watcher, &ResultWatcher::resultLinked,
-                [this] (const QString &resource) {
+        // Connecting the watcher, it is shared with the other favorites models
+        connect(m_results.data(), &LinkedResultSet::resultLinked,
+                this, [this] (const QString &resource) {
                     addResult(resource, -1);
                 });
 
-        connect(&m_watcher, &ResultWatcher::resultUnlinked,
-                [this] (const QString &resource) {
+        connect(m_results.data(), &LinkedResultSet::resultUnlinked,
+                this, [this] (const QString &resource) {
                     removeResult(resource);
                 });
 
@@ -226,11 +226,11 @@ public:
 
         // Loading the results without emitting any model signals
         qCDebug(KICKER_DEBUG) << "Query is" << m_query;
-        ResultSet results(m_query);
+        const QStringList resources = m_results->resources();
 
-        for (const auto& result: results) {
-            qCDebug(KICKER_DEBUG) << "Got " << result.resource() << " -->";
-            addResult(result.resource(), -1, false);
+        for (const auto& resource: resources) {
+            qCDebug(KICKER_DEBUG) << "Got " << resource << " -->";
+            addResult(resource, -1, false);
         }
 
         // Normalizing all the ids
@@ -444,7 +444,7 @@ public:
     KAStatsFavoritesModel *const q;
     KActivities::Consumer m_activities;
     Query m_query;
-    ResultWatcher m_watcher;
+    QSharedPointer<LinkedResultSet> m_results;
     QString m_clientId;
 
     QVector<NormalizedId> m_items;
@@ -0,0 +1,139 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#include "kastatsquerycache.h"
+
+#include <QHash>
+#include <QWeakPointer>
+
+#include <KActivities/Consumer>
+#include <KActivities/Stats/ResultModel>
+#include <KActivities/Stats/ResultSet>
+
+namespace KAStats = KActivities::Stats;
+
+using namespace KAStats;
+
+Q_GLOBAL_STATIC(KActivities::Consumer, activitiesConsumer)
+
+LinkedResultSet::LinkedResultSet(const Query &query)
+: QObject(nullptr)
+, m_watcher(query)
+{
+    connect(&m_watcher, &ResultWatcher::resultLinked, this,
+        [this](const QString &resource) {
+            if (!m_resources.contains(resource)) {
+                m_resources << resource;
+            }
+            emit resultLinked(resource);
+        });
+
+    connect(&m_watcher, &ResultWatcher::resultUnlinked, this,
+        [this](const QString &resource) {
+            m_resources.removeAll(resource);
+            emit resultUnlinked(resource);
+        });
+
+    ResultSet results(query);
+
+    for (const auto &result : results) {
+        m_resources << result.resource();
+    }
+}
+
+LinkedResultSet::~LinkedResultSet()
+{
+}
+
+QStringList LinkedResultSet::resources() const
+{
+    return m_resources;
+}
+
+namespace KAStatsQueryCache
+{
+
+static QString queryKey(const Query &query)
+{
+    QStringList key;
+
+    key << QString::number(query.selection())
+        << query.types().join(QLatin1Char(','))
+        << query.agents().join(QLatin1Char(','))
+        << query.activities().join(QLatin1Char(','))
+        << query.urlFilters().join(QLatin1Char(','))
+        << QString::number(query.ordering())
+        << QString::number(query.offset())
+        << QString::number(query.limit());
+
+    return key.join(QLatin1Char(';'));
+}
+
+// Entries are handed out as shared pointers, the cache only keeps weak references
+// so that a query is dropped when its last model goes away. They can go away from
+// within their own signals, hence deleteLater.
+template<typename T, typename Create>
+static QSharedPointer<T> cached(QHash<QString, QWeakPointer<T>> &cache, const QString &key, Create create)
+{
+    QSharedPointer<T> entry = cache.value(key).toStrongRef();
+
+    if (!entry) {
+        for (auto it = cache.begin(); it != cache.end();) {
+            it = it.value().isNull() ? cache.erase(it) : it + 1;
+        }
+
+        entry = QSharedPointer<T>(create(), [](T *object) { object->deleteLater(); });
+        cache.insert(key, entry);
+    }
+
+    return entry;
+}
+
+QSharedPointer<ResultModel> resultModel(const Query &query)
+{
+    static QHash<QString, QWeakPointer<ResultModel>> s_models;
+
+    return cached(s_models, queryKey(query), [&query]() {
+        ResultModel *model = new ResultModel(query);
+
+        if (model->canFetchMore(QModelIndex())) {
+            model->fetchMore(QModelIndex());
+        }
+
+        return model;
+    });
+}
+
+QSharedPointer<LinkedResultSet> linkedResults(const Query &query)
+{
+    static QHash<QString, QWeakPointer<LinkedResultSet>> s_resources;
+
+    // Users reload when the current activity changes, they must not be
+    // handed the resources loaded for the previous one
+    QString key = queryKey(query);
+    if (query.activities().contains(QStringLiteral(":current"))) {
+        key += QLatin1Char(';') + activitiesConsumer->currentActivity();
+    }
+
+    return cached(s_resources, key, [&query]() {
+        return new LinkedResultSet(query);
+    });
+}
+
+}
@@ -0,0 +1,73 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ ***************************************************************************/
+
+#ifndef KASTATSQUERYCACHE_H
+#define KASTATSQUERYCACHE_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include <KActivities/Stats/Query>
+#include <KActivities/Stats/ResultWatcher>
+
+namespace KActivities {
+namespace Stats {
+class ResultModel;
+}
+}
+
+/**
+ * Resources linked for a query, loaded once and kept up to date by a
+ * single watcher for all the models which use the same query.
+ */
+class LinkedResultSet : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit LinkedResultSet(const KActivities::Stats::Query &query);
+        ~LinkedResultSet() override;
+
+        QStringList resources() const;
+
+    Q_SIGNALS:
+        void resultLinked(const QString &resource);
+        void resultUnlinked(const QString &resource);
+
+    private:
+        KActivities::Stats::ResultWatcher m_watcher;
+        QStringList m_resources;
+};
+
+/**
+ * Process wide cache of KActivities Stats queries.
+ *
+ * Every Kicker, Kickoff and Dashboard instance asks for the same queries;
+ * they share one result model, or one set of linked resources, per query
+ * instead of each of them querying the database and watching for changes.
+ * Entries live as long as somebody holds them.
+ */
+namespace KAStatsQueryCache
+{
+    QSharedPointer<KActivities::Stats::ResultModel> resultModel(const KActivities::Stats::Query &query);
+    QSharedPointer<LinkedResultSet> linkedResults(const KActivities::Stats::Query &query);
+}
+
+#endif
@@ -22,6 +22,7 @@
 #include "appsmodel.h"
 #include "appentry.h"
 #include "kastatsfavoritesmodel.h"
+#include "kastatsquerycache.h"
 #include <kio_version.h>
 
 #include <config-X11.h>
@@ -68,7 +69,7 @@ InvalidAppsFilterProxy::InvalidAppsFilterProxy(AbstractModel *parentModel, QAbst
     connect(parentModel, &AbstractModel::favoritesModelChanged, this, &InvalidAppsFilterProxy::connectNewFavoritesModel);
     connectNewFavoritesModel();
 
-    sourceModel->setParent(this);
+    // The result model is shared with the other instances, see KAStatsQueryCache
     setSourceModel(sourceModel);
 }
 
@@ -343,13 +344,13 @@ bool RecentUsageModel::trigger(int row, const QString &actionId, const QVariant
                 sourceProxy = qobject_cast<QSortFilterProxyModel *>(sourceProxy->sourceModel());
             }
 
-            static_cast<ResultModel *>(m_activitiesModel.data())->forgetResource(idx.row());
+            m_activitiesModel->forgetResource(idx.row());
         }
 
         return false;
     } else if (actionId == QLatin1String("forgetAll")) {
         if (m_activitiesModel) {
-            static_cast<ResultModel *>(m_activitiesModel.data())->forgetAllResources();
+            m_activitiesModel->forgetAllResources();
         }
 
         return false;
@@ -444,7 +445,10 @@ void RecentUsageModel::refresh()
     QAbstractItemModel *oldModel = sourceModel();
     disconnectSignals();
     setSourceModel(nullptr);
-    delete oldModel;
+    if (oldModel != m_activitiesModel.data()) {
+        delete oldModel;
+    }
+    m_activitiesModel.clear();
 
     auto query = UsedResources
                     | (m_ordering == Recent ? RecentlyUsedFirst : HighScoredFirst)
@@ -470,14 +474,8 @@ void RecentUsageModel::refresh()
         }
     }
 
-    m_activitiesModel = new ResultModel(query);
-    QAbstractItemModel *model = m_activitiesModel;
-
-    QModelIndex index;
-
-    if (model->canFetchMore(index)) {
-        model->fetchMore(index);
-    }
+    m_activitiesModel = KAStatsQueryCache::resultModel(query);
+    QAbstractItemModel *model = m_activitiesModel.data();
 
     if (m_usage != OnlyDocs) {
         model = new InvalidAppsFilterProxy(this, model);
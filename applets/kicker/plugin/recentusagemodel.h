@@ -23,8 +23,15 @@
 #include "forwardingmodel.h"
 
 #include <QQmlParserStatus>
+#include <QSharedPointer>
 #include <QSortFilterProxyModel>
 
+namespace KActivities {
+namespace Stats {
+class ResultModel;
+}
+}
+
 class GroupSortProxy : public QSortFilterProxyModel
 {
     Q_OBJECT
@@ -105,7 +112,7 @@ class RecentUsageModel : public ForwardingModel, public QQmlParserStatus
         QString forgetAllActionName() const;
 
         IncludeUsage m_usage;
-        QPointer<QAbstractItemModel> m_activitiesModel;
+        QSharedPointer<KActivities::Stats::ResultModel> m_activitiesModel;
 
         Ordering m_ordering;
 
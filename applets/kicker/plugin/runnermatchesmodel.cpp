@@ -23,7 +23,9 @@
 #include "actionlist.h"
 
 #include <QAction>
+#include <QHash>
 #include <QIcon>
+#include <QVector>
 
 #include <KLocalizedString>
 #include <KRunner/RunnerManager>
@@ -214,40 +216,81 @@ bool RunnerMatchesModel::trigger(int row, const QString &actionId, const QVarian
 
 void RunnerMatchesModel::setMatches(const QList< Plasma::QueryMatch > &matches)
 {
-    int oldCount = m_matches.count();
-    int newCount = matches.count();
+    // Update the rows in place, matched by id, instead of replacing them, so views
+    // keep their items, and the current one, as more results stream in.
+    const int oldCount = m_matches.count();
+
+    // Remove the rows which are gone, an id can be used by more than one match
+    QHash<QString, int> remaining;
+    for (const Plasma::QueryMatch &match : matches) {
+        ++remaining[match.id()];
+    }
 
-    bool emitCountChange = (oldCount != newCount);
+    QVector<bool> keep(m_matches.count());
+    for (int row = 0; row < m_matches.count(); ++row) {
+        int &count = remaining[m_matches.at(row).id()];
+        keep[row] = count > 0;
+        if (keep[row]) {
+            --count;
+        }
+    }
 
-    int ceiling = qMin(oldCount, newCount);
-    bool emitDataChange = false;
+    for (int row = m_matches.count() - 1; row >= 0; --row) {
+        if (keep.at(row)) {
+            continue;
+        }
 
-    for (int row = 0; row < ceiling; ++row) {
-        if (!(m_matches.at(row) == matches.at(row))) {
-            emitDataChange = true;
-            m_matches[row] = matches.at(row);
+        int first = row;
+        while (first > 0 && !keep.at(first - 1)) {
+            --first;
         }
-    }
 
-    if (emitDataChange) {
-        emit dataChanged(index(0, 0), index(ceiling - 1, 0));
+        beginRemoveRows(QModelIndex(), first, row);
+        m_matches.erase(m_matches.begin() + first, m_matches.begin() + row + 1);
+        endRemoveRows();
+
+        row = first;
     }
 
-    if (newCount > oldCount) {
-        beginInsertRows(QModelIndex(), oldCount, newCount - 1);
+    // Every remaining row has a place in the new list: move, update or insert
+    for (int row = 0; row < matches.count(); ++row) {
+        const Plasma::QueryMatch &match = matches.at(row);
 
-        m_matches = matches;
+        if (row < m_matches.count() && m_matches.at(row).id() == match.id()) {
+            if (!(m_matches.at(row) == match)) {
+                m_matches[row] = match;
+                emit dataChanged(index(row, 0), index(row, 0));
+            }
+            continue;
+        }
 
-        endInsertRows();
-    } else if (newCount < oldCount) {
-        beginRemoveRows(QModelIndex(), newCount, oldCount - 1);
+        int from = -1;
+        for (int other = row + 1; other < m_matches.count(); ++other) {
+            if (m_matches.at(other).id() == match.id()) {
+                from = other;
+                break;
+            }
+        }
 
-        m_matches = matches;
+        if (from != -1) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            m_matches.move(from, row);
+            endMoveRows();
 
-        endRemoveRows();
+            if (!(m_matches.at(row) == match)) {
+                m_matches[row] = match;
+                emit dataChanged(index(row, 0), index(row, 0));
+            }
+        } else {
+            beginInsertRows(QModelIndex(), row, row);
+            m_matches.insert(row, match);
+            endInsertRows();
+        }
     }
 
-    if (emitCountChange) {
+    Q_ASSERT(m_matches.count() == matches.count());
+
+    if (oldCount != m_matches.count()) {
         emit countChanged();
     }
 }
@@ -37,6 +37,11 @@ RunnerModel::RunnerModel(QObject *parent) : QAbstractListModel(parent)
     m_queryTimer.setSingleShot(true);
     m_queryTimer.setInterval(10);
     connect(&m_queryTimer, &QTimer::timeout, this, &RunnerModel::startQuery);
+
+    // Apply the matches at most once per frame, runners report them independently
+    m_matchesTimer.setSingleShot(true);
+    m_matchesTimer.setInterval(16);
+    connect(&m_matchesTimer, &QTimer::timeout, this, &RunnerModel::applyMatches);
 }
 
 RunnerModel::~RunnerModel()
@@ -211,6 +216,18 @@ void RunnerModel::startQuery()
 
 void RunnerModel::matchesChanged(const QList<Plasma::QueryMatch> &matches)
 {
+    m_pendingMatches = matches;
+
+    if (!m_matchesTimer.isActive()) {
+        m_matchesTimer.start();
+    }
+}
+
+void RunnerModel::applyMatches()
+{
+    const QList<Plasma::QueryMatch> matches = m_pendingMatches;
+    m_pendingMatches.clear();
+
     // Group matches by runner.
     // We do not use a QMultiHash here because it keeps values in LIFO order, while we want FIFO.
     QHash<QString, QList<Plasma::QueryMatch> > matchesForRunner;
@@ -226,9 +243,10 @@ void RunnerModel::matchesChanged(const QList<Plasma::QueryMatch> &matches)
     }
 
     // Sort matches for all runners in descending order. This allows the best
-    // match to win whilest preserving order between runners.
+    // match to win whilest preserving order between runners. Matches which compare
+    // equal keep the order the runner gave them, so rows don't swap places.
     for (auto &list : matchesForRunner) {
-        std::sort(list.begin(), list.end(), qGreater<Plasma::QueryMatch>());
+        std::stable_sort(list.begin(), list.end(), qGreater<Plasma::QueryMatch>());
     }
 
     if (m_mergeResults) {
@@ -274,20 +292,33 @@ void RunnerModel::matchesChanged(const QList<Plasma::QueryMatch> &matches)
     }
 
     // At this point, matchesForRunner contains only matches for runners which
-    // do not have a model yet. Create new models for them.
+    // do not have a model yet. Create new models for them, in the order of the
+    // runners, so that sections don't show up in a different order for each query.
     if (!matchesForRunner.isEmpty()) {
-        auto it = matchesForRunner.constBegin();
-        auto end = matchesForRunner.constEnd();
+        QStringList runnerIds;
+        foreach (const QString &runnerId, m_runners) {
+            if (matchesForRunner.contains(runnerId)) {
+                runnerIds << runnerId;
+            }
+        }
+        QStringList otherRunnerIds = matchesForRunner.keys();
+        std::sort(otherRunnerIds.begin(), otherRunnerIds.end());
+        foreach (const QString &runnerId, otherRunnerIds) {
+            if (!runnerIds.contains(runnerId)) {
+                runnerIds << runnerId;
+            }
+        }
+
         int appendCount = 0;
 
-        for (; it != end; ++it) {
-            QList<Plasma::QueryMatch> matches = it.value();
+        foreach (const QString &runnerId, runnerIds) {
+            QList<Plasma::QueryMatch> matches = matchesForRunner.value(runnerId);
             Q_ASSERT(!matches.isEmpty());
-            RunnerMatchesModel *matchesModel = new RunnerMatchesModel(it.key(),
+            RunnerMatchesModel *matchesModel = new RunnerMatchesModel(runnerId,
                 matches.first().runner()->name(), m_runnerManager, this);
             matchesModel->setMatches(matches);
 
-            if (it.key() == QLatin1String("services")) {
+            if (runnerId == QLatin1String("services")) {
                 beginInsertRows(QModelIndex(), 0, 0);
                 m_models.prepend(matchesModel);
                 endInsertRows();
@@ -322,6 +353,9 @@ void RunnerModel::clear()
         m_runnerManager->reset();
     }
 
+    m_matchesTimer.stop();
+    m_pendingMatches.clear();
+
     if (m_models.isEmpty()) {
         return;
     }
@@ -89,6 +89,7 @@ class RunnerModel : public QAbstractListModel
     private Q_SLOTS:
         void startQuery();
         void matchesChanged(const QList<Plasma::QueryMatch> &matches);
+        void applyMatches();
 
     private:
         void createManager();
@@ -101,6 +102,8 @@ class RunnerModel : public QAbstractListModel
         QList<RunnerMatchesModel *> m_models;
         QString m_query;
         QTimer m_queryTimer;
+        QTimer m_matchesTimer;
+        QList<Plasma::QueryMatch> m_pendingMatches;
         bool m_mergeResults;
         bool m_deleteWhenEmpty;
 };
@@ -0,0 +1,86 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2,
+ *   or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * Measures how well the system tray keeps up with busy tray icons.
+ *
+ * It needs a session bus with the StatusNotifierWatcher kded module and, for the
+ * XEmbed clients, an X server with xembedsniproxy. To run it headless:
+ *
+ *   dbus-run-session -- xvfb-run -a sh -c 'xembedsniproxy & traybenchmark --items 50 --xembed 10'
+ */
+
+#include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+
+#include "mockclients.h"
+#include "traybenchmark.h"
+
+int main(int argc, char **argv)
+{
+    QApplication app(argc, argv);
+    QCommandLineParser parser;
+
+    const QString description = QStringLiteral("System tray benchmark");
+    const char version[] = "1.0";
+
+    app.setApplicationVersion(version);
+    parser.addVersionOption();
+    parser.addHelpOption();
+    parser.setApplicationDescription(description);
+
+    const QCommandLineOption itemsOption(QStringLiteral("items"), QStringLiteral("Number of StatusNotifierItem clients."), QStringLiteral("count"), QStringLiteral("20"));
+    const QCommandLineOption xembedOption(QStringLiteral("xembed"), QStringLiteral("Number of XEmbed clients."), QStringLiteral("count"), QStringLiteral("5"));
+    const QCommandLineOption iconOption(QStringLiteral("icon-interval"), QStringLiteral("Milliseconds between icon changes, 0 to disable."), QStringLiteral("msecs"), QStringLiteral("100"));
+    const QCommandLineOption toolTipOption(QStringLiteral("tooltip-interval"), QStringLiteral("Milliseconds between tooltip changes, 0 to disable."), QStringLiteral("msecs"), QStringLiteral("250"));
+    const QCommandLineOption menuOption(QStringLiteral("menu-interval"), QStringLiteral("Milliseconds between menu changes, 0 to disable."), QStringLiteral("msecs"), QStringLiteral("1000"));
+    const QCommandLineOption durationOption(QStringLiteral("duration"), QStringLiteral("Milliseconds to measure for."), QStringLiteral("msecs"), QStringLiteral("10000"));
+    QCommandLineOption clientsOption(QStringLiteral("clients"), QStringLiteral("Only run the mock clients."));
+    clientsOption.setFlags(QCommandLineOption::HiddenFromHelp);
+
+    parser.addOptions({itemsOption, xembedOption, iconOption, toolTipOption, menuOption, durationOption, clientsOption});
+    parser.process(app);
+
+    MockClients::Rates rates;
+    rates.icon = parser.value(iconOption).toInt();
+    rates.toolTip = parser.value(toolTipOption).toInt();
+    rates.menu = parser.value(menuOption).toInt();
+
+    const int items = parser.value(itemsOption).toInt();
+    const int xembedClients = parser.value(xembedOption).toInt();
+
+    if (parser.isSet(clientsOption)) {
+        MockClients clients(items, xembedClients, rates);
+        return app.exec();
+    }
+
+    TrayBenchmark::Options options;
+    options.statusNotifierItems = items;
+    options.xembedClients = xembedClients;
+    options.duration = parser.value(durationOption).toInt();
+    // The clients run in their own process, so their CPU time is told apart from the tray's
+    options.clientsArguments = QStringList{QStringLiteral("--clients")} + app.arguments().mid(1);
+
+    TrayBenchmark benchmark(options);
+    QObject::connect(&benchmark, &TrayBenchmark::finished, &app, &QCoreApplication::exit);
+    benchmark.start();
+
+    return app.exec();
+}
@@ -0,0 +1,214 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2,
+ *   or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "mockclients.h"
+
+#include <QDebug>
+#include <QMenu>
+#include <QPainter>
+#include <QPixmap>
+#include <QX11Info>
+
+#include <KStatusNotifierItem>
+
+#include <xcb/xcb.h>
+
+#include <chrono>
+#include <cstring>
+
+static const int s_iconSize = 22;
+// Tray menus change by growing up to this many entries, then starting over
+static const int s_maxMenuEntries = 8;
+
+#define SYSTEM_TRAY_REQUEST_DOCK 0
+#define XEMBED_MAPPED (1 << 0)
+
+qint64 monotonicUsecs()
+{
+    // steady_clock is CLOCK_MONOTONIC, shared by all processes of the machine
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static QColor frameColor(int number, int frame)
+{
+    return QColor::fromHsv((frame * 7 + number * 31) % 360, 255, 255);
+}
+
+static xcb_atom_t internAtom(xcb_connection_t *c, const QByteArray &name)
+{
+    const xcb_intern_atom_cookie_t cookie = xcb_intern_atom(c, false, name.length(), name.constData());
+    QScopedPointer<xcb_intern_atom_reply_t, QScopedPointerPodDeleter> reply(xcb_intern_atom_reply(c, cookie, nullptr));
+    return reply ? reply->atom : xcb_atom_t(XCB_ATOM_NONE);
+}
+
+XEmbedClient::XEmbedClient(int number)
+    : QWidget()
+    , m_number(number)
+{
+    setAttribute(Qt::WA_NativeWindow);
+    setFixedSize(s_iconSize, s_iconSize);
+}
+
+XEmbedClient::~XEmbedClient()
+{
+}
+
+void XEmbedClient::dock()
+{
+    xcb_connection_t *c = QX11Info::connection();
+
+    const xcb_atom_t selection = internAtom(c, "_NET_SYSTEM_TRAY_S" + QByteArray::number(QX11Info::appScreen()));
+    const xcb_get_selection_owner_cookie_t ownerCookie = xcb_get_selection_owner(c, selection);
+    QScopedPointer<xcb_get_selection_owner_reply_t, QScopedPointerPodDeleter> owner(xcb_get_selection_owner_reply(c, ownerCookie, nullptr));
+    if (!owner || owner->owner == XCB_WINDOW_NONE) {
+        qWarning() << "Nobody manages the XEmbed system tray, is xembedsniproxy running?";
+        return;
+    }
+
+    const xcb_atom_t xembedInfo = internAtom(c, "_XEMBED_INFO");
+    // protocol version 0, mapped by the embedder
+    const uint32_t info[] = {0, XEMBED_MAPPED};
+    xcb_change_property(c, XCB_PROP_MODE_REPLACE, winId(), xembedInfo, xembedInfo, 32, 2, info);
+
+    xcb_client_message_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.response_type = XCB_CLIENT_MESSAGE;
+    event.format = 32;
+    event.window = owner->owner;
+    event.type = internAtom(c, "_NET_SYSTEM_TRAY_OPCODE");
+    event.data.data32[0] = XCB_CURRENT_TIME;
+    event.data.data32[1] = SYSTEM_TRAY_REQUEST_DOCK;
+    event.data.data32[2] = winId();
+
+    xcb_send_event(c, false, owner->owner, XCB_EVENT_MASK_NO_EVENT, reinterpret_cast<const char *>(&event));
+    xcb_flush(c);
+}
+
+void XEmbedClient::animate()
+{
+    ++m_frame;
+    update();
+}
+
+void XEmbedClient::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+    painter.fillRect(rect(), frameColor(m_number, m_frame));
+}
+
+MockClients::MockClients(int statusNotifierItems, int xembedClients, const Rates &rates, QObject *parent)
+    : QObject(parent)
+{
+    m_items.reserve(statusNotifierItems);
+    for (int i = 0; i < statusNotifierItems; ++i) {
+        auto *item = new KStatusNotifierItem(QStringLiteral("traybenchmark-%1").arg(i), this);
+        item->setCategory(KStatusNotifierItem::ApplicationStatus);
+        item->setStatus(KStatusNotifierItem::Active);
+        item->setTitle(QStringLiteral("Benchmark item %1").arg(i));
+        item->setToolTipTitle(item->title());
+        m_items << item;
+    }
+
+    m_xembedClients.reserve(xembedClients);
+    for (int i = 0; i < xembedClients; ++i) {
+        auto *client = new XEmbedClient(i);
+        client->show();
+        client->dock();
+        m_xembedClients << client;
+    }
+
+    animateIcons();
+    animateMenus();
+
+    auto setup = [this](QTimer &timer, int interval, void (MockClients::*slot)()) {
+        if (interval > 0) {
+            timer.setInterval(interval);
+            connect(&timer, &QTimer::timeout, this, slot);
+            timer.start();
+        }
+    };
+    setup(m_iconTimer, rates.icon, &MockClients::animateIcons);
+    setup(m_toolTipTimer, rates.toolTip, &MockClients::animateToolTips);
+    setup(m_menuTimer, rates.menu, &MockClients::animateMenus);
+}
+
+MockClients::~MockClients()
+{
+    qDeleteAll(m_xembedClients);
+}
+
+void MockClients::animateIcons()
+{
+    ++m_frame;
+
+    for (int i = 0; i < m_items.count(); ++i) {
+        QPixmap pixmap(s_iconSize, s_iconSize);
+        pixmap.fill(frameColor(i, m_frame));
+
+        KStatusNotifierItem *item = m_items.at(i);
+        item->setIconByPixmap(QIcon(pixmap));
+    }
+
+    for (XEmbedClient *client : qAsConst(m_xembedClients)) {
+        client->animate();
+    }
+}
+
+void MockClients::animateToolTips()
+{
+    // Only tooltip changes carry a stamp, so every rate stays independent
+    for (KStatusNotifierItem *item : qAsConst(m_items)) {
+        stamp(item);
+    }
+}
+
+void MockClients::animateMenus()
+{
+    for (KStatusNotifierItem *item : qAsConst(m_items)) {
+        QMenu *menu = item->contextMenu();
+        // Keep the actions KStatusNotifierItem adds itself
+        const QList<QAction *> actions = menu->actions();
+        int added = 0;
+        for (QAction *action : actions) {
+            if (action->property("traybenchmark").toBool()) {
+                ++added;
+            }
+        }
+
+        if (added >= s_maxMenuEntries) {
+            for (QAction *action : actions) {
+                if (action->property("traybenchmark").toBool()) {
+                    menu->removeAction(action);
+                    delete action;
+                }
+            }
+            added = 0;
+        }
+
+        QAction *action = menu->addAction(QStringLiteral("Entry %1").arg(added + 1));
+        action->setProperty("traybenchmark", true);
+    }
+}
+
+void MockClients::stamp(KStatusNotifierItem *item)
+{
+    item->setToolTipSubTitle(QString::number(monotonicUsecs()));
+}
@@ -0,0 +1,94 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2,
+ *   or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef MOCKCLIENTS_H
+#define MOCKCLIENTS_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QWidget>
+
+class KStatusNotifierItem;
+
+/**
+ * Microseconds on the monotonic clock, comparable between processes.
+ * Mock items put it in their tooltip subtitle so the benchmark can tell how
+ * long an update took to reach the model
+ */
+qint64 monotonicUsecs();
+
+/**
+ * Legacy tray icon docked through the XEmbed system tray protocol, the way
+ * xembedsniproxy expects them
+ */
+class XEmbedClient : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit XEmbedClient(int number);
+    ~XEmbedClient() override;
+
+    void dock();
+    void animate();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    int m_number;
+    int m_frame = 0;
+};
+
+/**
+ * Spawns StatusNotifierItem and XEmbed tray icons which keep changing their icon,
+ * tooltip and menu at the given intervals, in milliseconds.
+ * An interval of 0 leaves that part alone
+ */
+class MockClients : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Rates {
+        int icon = 0;
+        int toolTip = 0;
+        int menu = 0;
+    };
+
+    MockClients(int statusNotifierItems, int xembedClients, const Rates &rates, QObject *parent = nullptr);
+    ~MockClients() override;
+
+private:
+    void animateIcons();
+    void animateToolTips();
+    void animateMenus();
+    void stamp(KStatusNotifierItem *item);
+
+    QVector<KStatusNotifierItem *> m_items;
+    QVector<XEmbedClient *> m_xembedClients;
+
+    QTimer m_iconTimer;
+    QTimer m_toolTipTimer;
+    QTimer m_menuTimer;
+    int m_frame = 0;
+};
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2,
+ *   or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "traybenchmark.h"
+#include "systemtraymodel.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusReply>
+#include <QDebug>
+#include <QFile>
+#include <QIcon>
+#include <QTextStream>
+
+#include <algorithm>
+
+#include <unistd.h>
+
+// How long the mock clients get to show up in the tray
+static const int s_startupTimeout = 30000;
+
+static qint64 iconKey(const QModelIndex &index)
+{
+    const QVariant decoration = index.data(Qt::DecorationRole);
+    if (decoration.userType() == QMetaType::QIcon) {
+        return decoration.value<QIcon>().cacheKey();
+    }
+    return qHash(decoration.toString());
+}
+
+static qint64 stamp(const QModelIndex &index)
+{
+    bool ok;
+    const qint64 usecs = index.data(static_cast<int>(StatusNotifierModel::Role::ToolTipSubTitle)).toString().toLongLong(&ok);
+    return ok ? usecs : -1;
+}
+
+TrayBenchmark::TrayBenchmark(const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_statusNotifierModel(new StatusNotifierModel(this))
+    , m_model(new SystemTrayModel(this))
+{
+    m_model->addSourceModel(m_statusNotifierModel);
+
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &TrayBenchmark::onRowsInserted);
+    connect(m_model, &QAbstractItemModel::dataChanged, this, &TrayBenchmark::onDataChanged);
+
+    m_timeout.setSingleShot(true);
+    connect(&m_timeout, &QTimer::timeout, this, [this]() {
+        if (m_measuring) {
+            report();
+            return;
+        }
+        qWarning() << "Only" << m_model->rowCount() << "tray items showed up, expected"
+                   << m_options.statusNotifierItems + m_options.xembedClients;
+        emit finished(1);
+    });
+
+    m_clients.setProcessChannelMode(QProcess::ForwardedChannels);
+    connect(&m_clients, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        qWarning() << "The mock clients failed:" << error;
+        m_timeout.stop();
+        emit finished(1);
+    });
+}
+
+TrayBenchmark::~TrayBenchmark()
+{
+    m_clients.kill();
+    m_clients.waitForFinished();
+}
+
+void TrayBenchmark::start()
+{
+    // The dataengine is loaded already, only the items count from here on
+    m_baselineMemory = residentMemory();
+
+    m_clients.start(QCoreApplication::applicationFilePath(), m_options.clientsArguments);
+    m_timeout.start(s_startupTimeout);
+}
+
+void TrayBenchmark::onRowsInserted()
+{
+    if (!m_measuring && m_model->rowCount() >= m_options.statusNotifierItems + m_options.xembedClients) {
+        startMeasuring();
+    }
+}
+
+void TrayBenchmark::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (!m_measuring) {
+        return;
+    }
+
+    const qint64 now = monotonicUsecs();
+
+    // Every role of an item is set on its own, only count what the mock clients changed
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const QModelIndex index = m_model->index(row, 0);
+        bool updated = false;
+
+        const qint64 usecs = stamp(index);
+        if (usecs >= 0 && usecs != m_stamps.value(row)) {
+            m_stamps.insert(row, usecs);
+            m_latencies << now - usecs;
+            updated = true;
+        }
+
+        const qint64 icon = iconKey(index);
+        if (icon != m_icons.value(row)) {
+            m_icons.insert(row, icon);
+            updated = true;
+        }
+
+        if (updated) {
+            ++m_updates;
+        }
+    }
+}
+
+void TrayBenchmark::startMeasuring()
+{
+    const int items = m_model->rowCount();
+    m_memoryPerItem = items ? (residentMemory() - m_baselineMemory) / items : 0;
+
+    for (int row = 0; row < items; ++row) {
+        const QModelIndex index = m_model->index(row, 0);
+        m_stamps.insert(row, stamp(index));
+        m_icons.insert(row, iconKey(index));
+    }
+
+    // Whoever owns a tray item takes part: the mock clients, xembedsniproxy for the XEmbed ones, and us
+    m_startCpuTimes.clear();
+    m_startCpuTimes.insert(QCoreApplication::applicationPid(), cpuTime(QCoreApplication::applicationPid()));
+
+    QDBusConnectionInterface *bus = QDBusConnection::sessionBus().interface();
+    for (int row = 0; row < m_statusNotifierModel->rowCount(); ++row) {
+        const QString source = m_statusNotifierModel->item(row)->data(static_cast<int>(StatusNotifierModel::Role::DataEngineSource)).toString();
+        const QDBusReply<uint> pid = bus->servicePid(source.section(QLatin1Char('/'), 0, 0));
+        if (pid.isValid() && !m_startCpuTimes.contains(pid.value())) {
+            m_startCpuTimes.insert(pid.value(), cpuTime(pid.value()));
+        }
+    }
+
+    m_measuring = true;
+    m_updates = 0;
+    m_latencies.clear();
+    m_clock.start();
+    m_timeout.start(m_options.duration);
+}
+
+void TrayBenchmark::report()
+{
+    const qint64 elapsed = m_clock.elapsed();
+
+    QTextStream out(stdout);
+    out << "Tray items: " << m_model->rowCount() << " (" << m_options.statusNotifierItems << " StatusNotifierItem, "
+        << m_options.xembedClients << " XEmbed)\n";
+    out << "Memory per item: " << m_memoryPerItem / 1024 << " KiB\n";
+    out << "Updates reflected by the model: " << m_updates << " in " << elapsed << " ms ("
+        << (elapsed ? m_updates * 1000 / elapsed : 0) << " per second)\n";
+
+    if (!m_latencies.isEmpty()) {
+        std::sort(m_latencies.begin(), m_latencies.end());
+        auto percentile = [this](int percent) {
+            return m_latencies.at((m_latencies.count() - 1) * percent / 100) / 1000.0;
+        };
+        out << "Tooltip latency: median " << percentile(50) << " ms, 95th percentile " << percentile(95)
+            << " ms, max " << percentile(100) << " ms\n";
+    }
+
+    out << "CPU time:\n";
+    for (auto it = m_startCpuTimes.constBegin(); it != m_startCpuTimes.constEnd(); ++it) {
+        const qint64 spent = cpuTime(it.key()) - it.value();
+        out << "  " << processName(it.key()) << " (" << it.key() << "): " << spent / 1000 << " ms, "
+            << (m_updates ? spent / m_updates : 0) << " us per update\n";
+    }
+    out.flush();
+
+    m_measuring = false;
+    emit finished(0);
+}
+
+qint64 TrayBenchmark::residentMemory()
+{
+    // Second field of statm is the resident set size in pages
+    QFile file(QStringLiteral("/proc/self/statm"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    if (fields.count() < 2) {
+        return 0;
+    }
+
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+}
+
+qint64 TrayBenchmark::cpuTime(qint64 pid)
+{
+    QFile file(QStringLiteral("/proc/%1/stat").arg(pid));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    // The process name can contain spaces, the fields we want come after it:
+    // utime and stime are the 14th and 15th, counted from the pid
+    const QByteArray stat = file.readAll();
+    const QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    if (fields.count() < 13) {
+        return 0;
+    }
+
+    const qint64 ticks = fields.at(11).toLongLong() + fields.at(12).toLongLong();
+    return ticks * 1000000 / sysconf(_SC_CLK_TCK);
+}
+
+QString TrayBenchmark::processName(qint64 pid)
+{
+    QFile file(QStringLiteral("/proc/%1/comm").arg(pid));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromLocal8Bit(file.readAll().trimmed());
+}
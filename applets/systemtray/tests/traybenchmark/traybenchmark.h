@@ -0,0 +1,98 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2,
+ *   or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAYBENCHMARK_H
+#define TRAYBENCHMARK_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+#include "mockclients.h"
+
+class QModelIndex;
+class StatusNotifierModel;
+class SystemTrayModel;
+
+/**
+ * Drives the mock tray clients in a child process and watches a SystemTrayModel
+ * fed by the statusnotifieritem dataengine, the same way the system tray applet does.
+ *
+ * Once all items showed up in the model it reports:
+ * - the memory the model and dataengine use per item
+ * - the latency between a mock item updating its tooltip and the model reflecting it
+ * - the CPU time every process owning tray items, and this one, spent per model update
+ */
+class TrayBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        int statusNotifierItems = 0;
+        int xembedClients = 0;
+        // Length of the measurement, in milliseconds
+        int duration = 0;
+        // Arguments that make this program spawn the mock clients
+        QStringList clientsArguments;
+    };
+
+    explicit TrayBenchmark(const Options &options, QObject *parent = nullptr);
+    ~TrayBenchmark() override;
+
+    void start();
+
+Q_SIGNALS:
+    void finished(int exitCode);
+
+private:
+    void onRowsInserted();
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void startMeasuring();
+    void report();
+
+    static qint64 residentMemory();
+    static qint64 cpuTime(qint64 pid);
+    static QString processName(qint64 pid);
+
+    Options m_options;
+
+    StatusNotifierModel *m_statusNotifierModel;
+    SystemTrayModel *m_model;
+    QProcess m_clients;
+    QTimer m_timeout;
+
+    bool m_measuring = false;
+    QElapsedTimer m_clock;
+    qint64 m_baselineMemory = 0;
+    qint64 m_memoryPerItem = 0;
+    QHash<qint64, qint64> m_startCpuTimes;
+
+    // Last tooltip stamp and icon seen per row, to tell updates from repeated dataChanged
+    QHash<int, qint64> m_stamps;
+    QHash<int, qint64> m_icons;
+    int m_updates = 0;
+    QVector<qint64> m_latencies;
+};
+
+#endif
@@ -73,7 +73,7 @@ void GridLayoutManager::parseLayout(const QString &savedLayout)
 
 bool GridLayoutManager::itemIsManaged(ItemContainer *item)
 {
-    return m_pointsForItem.contains(item);
+    return m_cellsForItem.contains(item);
 }
 
 inline void maintainItemEdgeAlignment(ItemContainer *item, const QRectF &newRect, const QRectF &oldRect)
@@ -108,8 +108,8 @@ inline void maintainItemEdgeAlignment(ItemContainer *item, const QRectF &newRect
 
 void GridLayoutManager::layoutGeometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
 {
-    m_grid.clear();
-    m_pointsForItem.clear();
+    m_occupancy.clear();
+    m_cellsForItem.clear();
     for (auto *item : layout()->childItems()) {
         // Stash the old config
         //m_parsedConfig[item->key()] = {item->x(), item->y(), item->width(), item->height(), item->rotation()};
@@ -126,8 +126,8 @@ void GridLayoutManager::layoutGeometryChanged(const QRectF &newGeometry, const Q
 
 void GridLayoutManager::resetLayout()
 {
-    m_grid.clear();
-    m_pointsForItem.clear();
+    m_occupancy.clear();
+    m_cellsForItem.clear();
     for (auto *item : layout()->childItems()) {
         ItemContainer *itemCont = qobject_cast<ItemContainer*>(item);
         if (itemCont && itemCont != layout()->placeHolder()) {
@@ -140,8 +140,8 @@ void GridLayoutManager::resetLayout()
 
 void GridLayoutManager::resetLayoutFromConfig()
 {
-    m_grid.clear();
-    m_pointsForItem.clear();
+    m_occupancy.clear();
+    m_cellsForItem.clear();
     QList<ItemContainer *> missingItems;
 
     for (auto *item : layout()->childItems()) {
@@ -193,14 +193,17 @@ bool GridLayoutManager::isRectAvailable(const QRectF &rect)
     
     const QRect cellItemGeom = cellBasedGeometry(rect);
 
-    for (int row = cellItemGeom.top(); row <= cellItemGeom.bottom(); ++row) {
-        for (int column = cellItemGeom.left(); column <= cellItemGeom.right(); ++column) {
-            if (!isCellAvailable(QPair<int, int>(row, column))) {
-                return false;
-            }
-        }
+    if (cellItemGeom.isEmpty()) {
+        return true;
     }
-    return true;
+
+    syncOccupancySize();
+
+    if (!QRect(0, 0, m_occupancy.columns(), m_occupancy.rows()).contains(cellItemGeom)) {
+        return false;
+    }
+
+    return m_occupancy.takenCount(cellItemGeom) == 0;
 }
 
 bool GridLayoutManager::assignSpaceImpl(ItemContainer *item)
@@ -214,13 +217,8 @@ bool GridLayoutManager::assignSpaceImpl(ItemContainer *item)
 
     const QRect cellItemGeom = cellBasedGeometry(itemGeometry(item));
 
-    for (int row = cellItemGeom.top(); row <= cellItemGeom.bottom(); ++row) {
-        for (int column = cellItemGeom.left(); column <= cellItemGeom.right(); ++column) {
-            QPair<int, int> cell(row, column);
-            m_grid.insert(cell, item);
-            m_pointsForItem[item].insert(cell);
-        }
-    }
+    m_occupancy.setTaken(cellItemGeom, true);
+    m_cellsForItem[item] = cellItemGeom;
 
     // Reorder items tab order
     for (auto *i2 : layout()->childItems()) {
@@ -245,31 +243,53 @@ bool GridLayoutManager::assignSpaceImpl(ItemContainer *item)
 
 void GridLayoutManager::releaseSpaceImpl(ItemContainer *item)
 {
-    auto it = m_pointsForItem.find(item);
+    auto it = m_cellsForItem.find(item);
 
-    if (it == m_pointsForItem.end()) {
+    if (it == m_cellsForItem.end()) {
         return;
     }
 
-    for (const auto &point : it.value()) {
-        m_grid.remove(point);
-    }
+    syncOccupancySize();
+    m_occupancy.setTaken(it.value().intersected(QRect(0, 0, m_occupancy.columns(), m_occupancy.rows())), false);
 
-    m_pointsForItem.erase(it);
+    m_cellsForItem.erase(it);
 
     disconnect(item, &ItemContainer::sizeHintsChanged, this, nullptr);
 }
 
 int GridLayoutManager::rows() const
 {
+    if (cellSize().height() <= 0) {
+        return 0;
+    }
     return layout()->height() / cellSize().height();
 }
 
 int GridLayoutManager::columns() const
 {
+    if (cellSize().width() <= 0) {
+        return 0;
+    }
     return layout()->width() / cellSize().width();
 }
 
+void GridLayoutManager::syncOccupancySize() const
+{
+    const int gridRows = rows();
+    const int gridColumns = columns();
+
+    if (m_occupancy.rows() == gridRows && m_occupancy.columns() == gridColumns) {
+        return;
+    }
+
+    m_occupancy.resize(gridRows, gridColumns);
+
+    const QRect bounds(0, 0, gridColumns, gridRows);
+    for (const QRect &cells : m_cellsForItem) {
+        m_occupancy.setTaken(cells.intersected(bounds), true);
+    }
+}
+
 void GridLayoutManager::adjustToItemSizeHints(ItemContainer *item)
 {
     if (!item->layoutAttached() || item->editMode()) {
@@ -354,7 +374,12 @@ bool GridLayoutManager::isOutOfBounds(const QPair<int, int> &cell) const
 
 bool GridLayoutManager::isCellAvailable(const QPair<int, int> &cell) const
 {
-    return !isOutOfBounds(cell) && !m_grid.contains(cell);
+    if (isOutOfBounds(cell)) {
+        return false;
+    }
+
+    syncOccupancySize();
+    return !m_occupancy.isTaken(cell.first, cell.second);
 }
 
 QRectF GridLayoutManager::itemGeometry(QQuickItem *item) const
@@ -385,90 +410,93 @@ QPair<int, int> GridLayoutManager::nextCell(const QPair<int, int> &cell, Applets
     return nCell;
 }
 
-QPair<int, int> GridLayoutManager::nextAvailableCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const
+QPair<int, int> GridLayoutManager::nextCellWithState(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction, bool taken) const
 {
-    QPair<int, int> nCell = cell;
-    while (!isOutOfBounds(nCell)) {
-        nCell = nextCell(nCell, direction);
-
-        if (isOutOfBounds(nCell)) {
-            switch (direction) {
-            case AppletsLayout::AppletsLayout::BottomToTop:
-                nCell.first = rows() - 1;
-                --nCell.second;
-                break;
-            case AppletsLayout::AppletsLayout::TopToBottom:
-                nCell.first = 0;
-                ++nCell.second;
-                break;
-            case AppletsLayout::AppletsLayout::RightToLeft:
-                --nCell.first;
-                nCell.second = columns() - 1;
-                break;
-            case AppletsLayout::AppletsLayout::LeftToRight:
-            default:
-                ++nCell.first;
-                nCell.second = 0;
-                break;
+    if (isOutOfBounds(cell)) {
+        return QPair<int, int>(-1, -1);
+    }
+
+    syncOccupancySize();
+
+    int row = cell.first;
+    int column = cell.second;
+
+    switch (direction) {
+    case AppletsLayout::AppletsLayout::BottomToTop:
+        // Columns from bottom to top, starting from the rightmost one
+        for (--row; column >= 0; --column, row = rows() - 1) {
+            const int found = m_occupancy.findInColumn(column, row, taken, false);
+            if (found >= 0) {
+                return QPair<int, int>(found, column);
             }
         }
-
-        if (isCellAvailable(nCell)) {
-            return nCell;
+        break;
+    case AppletsLayout::AppletsLayout::TopToBottom:
+        // Columns from top to bottom, starting from the leftmost one
+        for (++row; column < columns(); ++column, row = 0) {
+            const int found = m_occupancy.findInColumn(column, row, taken, true);
+            if (found >= 0) {
+                return QPair<int, int>(found, column);
+            }
+        }
+        break;
+    case AppletsLayout::AppletsLayout::RightToLeft:
+        // Rows from right to left, starting from the bottom one
+        for (--column; row >= 0; --row, column = columns() - 1) {
+            const int found = m_occupancy.findInRow(row, column, taken, false);
+            if (found >= 0) {
+                return QPair<int, int>(row, found);
+            }
+        }
+        break;
+    case AppletsLayout::AppletsLayout::LeftToRight:
+    default:
+        // Rows from left to right, starting from the top one
+        for (++column; row < rows(); ++row, column = 0) {
+            const int found = m_occupancy.findInRow(row, column, taken, true);
+            if (found >= 0) {
+                return QPair<int, int>(row, found);
+            }
         }
+        break;
     }
 
     return QPair<int, int>(-1, -1);
 }
 
-QPair<int, int> GridLayoutManager::nextTakenCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const
+QPair<int, int> GridLayoutManager::nextAvailableCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const
 {
-    QPair<int, int> nCell = cell;
-    while (!isOutOfBounds(nCell)) {
-        nCell = nextCell(nCell, direction);
-
-        if (isOutOfBounds(nCell)) {
-            switch (direction) {
-            case AppletsLayout::AppletsLayout::BottomToTop:
-                nCell.first = rows() - 1;
-                --nCell.second;
-                break;
-            case AppletsLayout::AppletsLayout::TopToBottom:
-                nCell.first = 0;
-                ++nCell.second;
-                break;
-            case AppletsLayout::AppletsLayout::RightToLeft:
-                --nCell.first;
-                nCell.second = columns() - 1;
-                break;
-            case AppletsLayout::AppletsLayout::LeftToRight:
-            default:
-                ++nCell.first;
-                nCell.second = 0;
-                break;
-            }
-        }
-
-        if (!isCellAvailable(nCell)) {
-            return nCell;
-        }
-    }
+    return nextCellWithState(cell, direction, false);
+}
 
-    return QPair<int, int>(-1, -1);
+QPair<int, int> GridLayoutManager::nextTakenCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const
+{
+    return nextCellWithState(cell, direction, true);
 }
 
 int GridLayoutManager::freeSpaceInDirection(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const
 {
-    QPair<int, int> nCell = cell;
+    if (!isCellAvailable(cell)) {
+        return 0;
+    }
 
-    int avail = 0;
+    int taken;
 
-    while (isCellAvailable(nCell)) {
-        ++avail;
-        nCell = nextCell(nCell, direction);
+    switch (direction) {
+    case AppletsLayout::AppletsLayout::BottomToTop:
+        taken = m_occupancy.findInColumn(cell.second, cell.first, true, false);
+        return cell.first - taken;
+    case AppletsLayout::AppletsLayout::TopToBottom:
+        taken = m_occupancy.findInColumn(cell.second, cell.first, true, true);
+        return (taken < 0 ? rows() : taken) - cell.first;
+    case AppletsLayout::AppletsLayout::RightToLeft:
+        taken = m_occupancy.findInRow(cell.first, cell.second, true, false);
+        return cell.second - taken;
+    case AppletsLayout::AppletsLayout::LeftToRight:
+    default:
+        taken = m_occupancy.findInRow(cell.first, cell.second, true, true);
+        return (taken < 0 ? columns() : taken) - cell.second;
     }
-
-    return avail;
 }
 
 QRectF GridLayoutManager::nextAvailableSpace(ItemContainer *item, const QSizeF &minimumSize, AppletsLayout::PreferredLayoutDirection direction) const
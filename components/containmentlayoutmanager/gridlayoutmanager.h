@@ -22,6 +22,7 @@
 
 #include "abstractlayoutmanager.h"
 #include "appletcontainer.h"
+#include "gridoccupancy.h"
 
 class AppletsLayout;
 class ItemContainer;
@@ -91,6 +92,12 @@ private:
     // The next cell given the direction
     QPair<int, int> nextCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const;
 
+    // The next cell in the given direction which is taken or available, wrapping at the end of rows or columns
+    QPair<int, int> nextCellWithState(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction, bool taken) const;
+
+    // Makes sure the occupancy grid has the current amount of rows and columns
+    void syncOccupancySize() const;
+
     // The next cell that is available given the direction
     QPair<int, int> nextAvailableCell(const QPair<int, int> &cell, AppletsLayout::PreferredLayoutDirection direction) const;
 
@@ -105,9 +112,10 @@ private:
      */
     void adjustToItemSizeHints(ItemContainer *item);
 
-    // What is the item that occupies the point. The point is expressed in cells rather than pixels. a qpair rather a QPointF as QHash doesn't support identification by QPointF
-    QHash <QPair<int, int>, ItemContainer *> m_grid;
-    QHash <ItemContainer *, QSet<QPair<int, int> > > m_pointsForItem;
+    // Which cells are taken. Rebuilt from m_cellsForItem when the amount of rows or columns changes
+    mutable GridOccupancy m_occupancy;
+    // The cell based geometry each item occupies
+    QHash <ItemContainer *, QRect> m_cellsForItem;
 
     QHash <QString, Geom> m_parsedConfig;
 };
@@ -0,0 +1,227 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Library General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#include "gridoccupancy.h"
+
+#include <QtAlgorithms>
+
+static const int s_wordBits = 64;
+static const quint64 s_allBits = ~quint64(0);
+
+GridOccupancy::GridOccupancy()
+{
+}
+
+GridOccupancy::~GridOccupancy()
+{
+}
+
+void GridOccupancy::resize(int rows, int columns)
+{
+    m_rows = qMax(0, rows);
+    m_columns = qMax(0, columns);
+    m_stride = (m_columns + s_wordBits - 1) / s_wordBits;
+    m_bits.fill(0, m_rows * m_stride);
+    m_summedAreaDirty = true;
+}
+
+void GridOccupancy::clear()
+{
+    m_bits.fill(0);
+    m_summedAreaDirty = true;
+}
+
+int GridOccupancy::rows() const
+{
+    return m_rows;
+}
+
+int GridOccupancy::columns() const
+{
+    return m_columns;
+}
+
+void GridOccupancy::setTaken(const QRect &rect, bool taken)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    Q_ASSERT(QRect(0, 0, m_columns, m_rows).contains(rect));
+
+    const int firstWord = rect.left() / s_wordBits;
+    const int lastWord = rect.right() / s_wordBits;
+    const quint64 firstMask = s_allBits << (rect.left() % s_wordBits);
+    const quint64 lastMask = s_allBits >> (s_wordBits - 1 - rect.right() % s_wordBits);
+
+    for (int row = rect.top(); row <= rect.bottom(); ++row) {
+        quint64 *line = m_bits.data() + row * m_stride;
+        for (int word = firstWord; word <= lastWord; ++word) {
+            quint64 mask = s_allBits;
+            if (word == firstWord) {
+                mask &= firstMask;
+            }
+            if (word == lastWord) {
+                mask &= lastMask;
+            }
+
+            if (taken) {
+                line[word] |= mask;
+            } else {
+                line[word] &= ~mask;
+            }
+        }
+    }
+
+    m_summedAreaDirty = true;
+}
+
+bool GridOccupancy::isTaken(int row, int column) const
+{
+    Q_ASSERT(row >= 0 && row < m_rows && column >= 0 && column < m_columns);
+
+    const quint64 word = m_bits.at(row * m_stride + column / s_wordBits);
+    return word & (quint64(1) << (column % s_wordBits));
+}
+
+int GridOccupancy::takenCount(const QRect &rect) const
+{
+    if (rect.isEmpty()) {
+        return 0;
+    }
+
+    Q_ASSERT(QRect(0, 0, m_columns, m_rows).contains(rect));
+
+    updateSummedArea();
+
+    const int width = m_columns + 1;
+    const int *sat = m_summedArea.constData();
+    const int top = rect.top() * width;
+    const int bottom = (rect.bottom() + 1) * width;
+    const int left = rect.left();
+    const int right = rect.right() + 1;
+
+    return sat[bottom + right] - sat[top + right] - sat[bottom + left] + sat[top + left];
+}
+
+int GridOccupancy::findInRow(int row, int column, bool taken, bool forward) const
+{
+    if (row < 0 || row >= m_rows || column < 0 || column >= m_columns) {
+        return -1;
+    }
+
+    const quint64 *line = m_bits.constData() + row * m_stride;
+    int word = column / s_wordBits;
+    // Look for set bits: when searching free cells, invert the words
+    quint64 bits = taken ? line[word] : ~line[word];
+
+    if (forward) {
+        bits &= s_allBits << (column % s_wordBits);
+        while (!bits) {
+            if (++word >= m_stride) {
+                return -1;
+            }
+            bits = taken ? line[word] : ~line[word];
+        }
+        const int found = word * s_wordBits + qCountTrailingZeroBits(bits);
+        // The padding bits past the last column are never taken, but they read as free
+        return found < m_columns ? found : -1;
+    } else {
+        bits &= s_allBits >> (s_wordBits - 1 - column % s_wordBits);
+        while (!bits) {
+            if (--word < 0) {
+                return -1;
+            }
+            bits = taken ? line[word] : ~line[word];
+        }
+        return word * s_wordBits + s_wordBits - 1 - qCountLeadingZeroBits(bits);
+    }
+}
+
+int GridOccupancy::findInColumn(int column, int row, bool taken, bool forward) const
+{
+    if (row < 0 || row >= m_rows || column < 0 || column >= m_columns) {
+        return -1;
+    }
+
+    updateSummedArea();
+
+    // Whether the rows between row and other, both included, contain a cell in the searched state.
+    // This is monotonic in the distance from row, so binary search for the nearest match
+    auto matches = [this, column, row, taken](int other) {
+        const int first = qMin(row, other);
+        const int last = qMax(row, other);
+        const int count = takenInColumn(column, first, last);
+        return taken ? count > 0 : count < last - first + 1;
+    };
+
+    int low = row;
+    int high = forward ? m_rows - 1 : 0;
+
+    if (!matches(high)) {
+        return -1;
+    }
+
+    while (low != high) {
+        const int mid = forward ? low + (high - low) / 2 : low - (low - high) / 2;
+        if (matches(mid)) {
+            high = mid;
+        } else {
+            low = forward ? mid + 1 : mid - 1;
+        }
+    }
+
+    return low;
+}
+
+int GridOccupancy::takenInColumn(int column, int firstRow, int lastRow) const
+{
+    const int width = m_columns + 1;
+    const int *sat = m_summedArea.constData();
+    const int top = firstRow * width;
+    const int bottom = (lastRow + 1) * width;
+
+    return sat[bottom + column + 1] - sat[top + column + 1] - sat[bottom + column] + sat[top + column];
+}
+
+void GridOccupancy::updateSummedArea() const
+{
+    if (!m_summedAreaDirty) {
+        return;
+    }
+
+    const int width = m_columns + 1;
+    m_summedArea.fill(0, (m_rows + 1) * width);
+    int *sat = m_summedArea.data();
+
+    for (int row = 0; row < m_rows; ++row) {
+        const quint64 *line = m_bits.constData() + row * m_stride;
+        const int *above = sat + row * width;
+        int *current = sat + (row + 1) * width;
+        int rowSum = 0;
+
+        for (int column = 0; column < m_columns; ++column) {
+            rowSum += (line[column / s_wordBits] >> (column % s_wordBits)) & 1;
+            current[column + 1] = above[column + 1] + rowSum;
+        }
+    }
+
+    m_summedAreaDirty = false;
+}
@@ -0,0 +1,99 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Library General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ */
+
+#pragma once
+
+#include <QRect>
+#include <QVector>
+
+/**
+ * Dense occupancy map of a cell grid.
+ *
+ * Every row is stored as a run of 64 bit words, one bit per cell, so free and taken
+ * cells along a row can be searched a word at a time.
+ * A summed-area table of taken cells, rebuilt lazily after modifications, answers
+ * "how many cells of this rectangle are taken" in constant time.
+ *
+ * Rectangles are expressed in cells: x is the column and y is the row.
+ */
+class GridOccupancy
+{
+public:
+    GridOccupancy();
+    ~GridOccupancy();
+
+    /**
+     * Resizes the grid to the given amount of cells, all cells become free
+     */
+    void resize(int rows, int columns);
+
+    /**
+     * Marks every cell as free
+     */
+    void clear();
+
+    int rows() const;
+    int columns() const;
+
+    /**
+     * Marks all the cells of rect as taken or free.
+     * rect must be inside the grid
+     */
+    void setTaken(const QRect &rect, bool taken);
+
+    /**
+     * @returns true if the cell is taken, the cell must be inside the grid
+     */
+    bool isTaken(int row, int column) const;
+
+    /**
+     * @returns how many cells of rect are taken, rect must be inside the grid
+     */
+    int takenCount(const QRect &rect) const;
+
+    /**
+     * @returns the first column starting from column (included), going right if forward is true
+     * or left otherwise, whose cell is taken if taken is true or free otherwise; -1 if there is none
+     */
+    int findInRow(int row, int column, bool taken, bool forward) const;
+
+    /**
+     * @returns the first row starting from row (included), going down if forward is true
+     * or up otherwise, whose cell is taken if taken is true or free otherwise; -1 if there is none
+     */
+    int findInColumn(int column, int row, bool taken, bool forward) const;
+
+private:
+    void updateSummedArea() const;
+
+    // Taken cells in the rows [firstRow, lastRow] of column
+    inline int takenInColumn(int column, int firstRow, int lastRow) const;
+
+    int m_rows = 0;
+    int m_columns = 0;
+    // Words per row
+    int m_stride = 0;
+    QVector<quint64> m_bits;
+
+    // (m_rows + 1) * (m_columns + 1) entries, entry (r, c) is the number of taken cells above and at the left of it
+    mutable QVector<int> m_summedArea;
+    mutable bool m_summedAreaDirty = true;
+};
+
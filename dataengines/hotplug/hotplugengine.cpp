@@ -42,6 +42,9 @@
 
 //#define HOTPLUGENGINE_TIMING
 
+// Devices plugged within this many ms of each other are processed together
+static const int s_addedDevicesDelay = 100;
+
 HotplugEngine::HotplugEngine(QObject* parent, const QVariantList& args)
     : Plasma::DataEngine(parent, args),
       m_dirWatch(new KDirWatch(this))
@@ -102,9 +105,7 @@ void HotplugEngine::processNextStartupDevice()
         m_startList.erase(it);
     }
 
-    if (m_startList.isEmpty()) {
-        m_predicates.clear();
-    } else {
+    if (!m_startList.isEmpty()) {
         QTimer::singleShot(0, this, &HotplugEngine::processNextStartupDevice);
     }
 }
@@ -112,6 +113,7 @@ void HotplugEngine::processNextStartupDevice()
 void HotplugEngine::findPredicates()
 {
     m_predicates.clear();
+    m_actions.clear();
     QStringList files;
     const QStringList dirs = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QStringLiteral("solid/actions"), QStandardPaths::LocateDirectory);
     Q_FOREACH (const QString& dir, dirs) {
@@ -121,11 +123,24 @@ void HotplugEngine::findPredicates()
         }
     }
     //qDebug() << files;
+    // Files of the more important folders come last and replace the others
     foreach (const QString &path, files) {
         KDesktopFile cfg(path);
         const QString string_predicate = cfg.desktopGroup().readEntry("X-KDE-Solid-Predicate");
         //qDebug() << path << string_predicate;
-        m_predicates.insert(QUrl(path).fileName(), Solid::Predicate::fromString(string_predicate));
+        const QString desktop = QUrl(path).fileName();
+        m_predicates.insert(desktop, Solid::Predicate::fromString(string_predicate));
+
+        const QList<KServiceAction> services = KDesktopFileActions::userDefinedServices(path, cfg, true);
+        if (!services.isEmpty()) {
+            Plasma::DataEngine::Data action;
+            action.insert(QStringLiteral("predicate"), desktop);
+            action.insert(QStringLiteral("text"), services[0].text());
+            action.insert(QStringLiteral("icon"), services[0].icon());
+            m_actions.insert(desktop, action);
+        } else {
+            m_actions.remove(desktop);
+        }
     }
 
     if (m_predicates.isEmpty()) {
@@ -184,14 +199,9 @@ QVariantList HotplugEngine::actionsForPredicates(const QStringList &predicates)
     actions.reserve(predicates.count());
 
     for (const QString &desktop : predicates) {
-        const QString actionUrl = QStandardPaths::locate(QStandardPaths::GenericDataLocation, "solid/actions/" + desktop);
-        QList<KServiceAction> services = KDesktopFileActions::userDefinedServices(actionUrl, true);
-        if (!services.isEmpty()) {
-            Plasma::DataEngine::Data action;
-            action.insert(QStringLiteral("predicate"), desktop);
-            action.insert(QStringLiteral("text"), services[0].text());
-            action.insert(QStringLiteral("icon"), services[0].icon());
-            actions << action;
+        const auto it = m_actions.constFind(desktop);
+        if (it != m_actions.constEnd()) {
+            actions << *it;
         }
     }
 
@@ -200,8 +210,21 @@ QVariantList HotplugEngine::actionsForPredicates(const QStringList &predicates)
 
 void HotplugEngine::onDeviceAdded(const QString &udi)
 {
-    Solid::Device device(udi);
-    handleDeviceAdded(device);
+    if (m_addedDevices.isEmpty()) {
+        QTimer::singleShot(s_addedDevicesDelay, this, &HotplugEngine::processAddedDevices);
+    }
+    m_addedDevices << udi;
+}
+
+void HotplugEngine::processAddedDevices()
+{
+    const QStringList addedDevices = m_addedDevices;
+    m_addedDevices.clear();
+
+    for (const QString &udi : addedDevices) {
+        Solid::Device device(udi);
+        handleDeviceAdded(device);
+    }
 }
 
 void HotplugEngine::handleDeviceAdded(Solid::Device &device, bool added)
@@ -279,6 +302,10 @@ void HotplugEngine::onDeviceRemoved(const QString &udi)
         return;
     }
 
+    if (m_addedDevices.removeAll(udi) > 0) {
+        return;
+    }
+
     m_devices.remove(udi);
     removeSource(udi);
 }
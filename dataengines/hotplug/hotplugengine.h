@@ -55,10 +55,16 @@ class HotplugEngine : public Plasma::DataEngine
 
     private Q_SLOTS:
         void processNextStartupDevice();
+        void processAddedDevices();
         void updatePredicates(const QString &path);
 
     private:
+        // Predicates and actions of the solid action files by file name, read once
+        // and then only when the files change
         QHash<QString, Solid::Predicate> m_predicates;
+        QHash<QString, QVariant> m_actions;
+        // Devices plugged since the last batch, e.g. all the ones of a docking station
+        QStringList m_addedDevices;
         QHash<QString, Solid::Device> m_startList;
         QHash<QString, Solid::Device> m_devices;
         Solid::Predicate m_encryptedPredicate;
@@ -26,12 +26,16 @@
 
 #include <QApplication>
 #include <QDebug>
+#include <QFileSystemWatcher>
 #include <KFormat>
 #include <KIO/FileSystemFreeSpaceJob>
 #include <KNotification>
 
 #include <Plasma/DataContainer>
 
+//delay before sampling free space after a mount or a change, to batch bursts of them
+static const int s_storageSpaceDelay = 1000;
+
 //TODO: implement in libsolid2
 namespace
 {
@@ -50,12 +54,18 @@ namespace
 
 SolidDeviceEngine::SolidDeviceEngine(QObject* parent, const QVariantList& args)
         : Plasma::DataEngine(parent, args),
+          m_mountWatcher(new QFileSystemWatcher(this)),
           m_temperature(nullptr),
           m_notifier(nullptr)
 {
     Q_UNUSED(args)
     m_signalmanager = new DeviceSignalMapManager(this);
 
+    m_storageSpaceTimer.setSingleShot(true);
+    m_storageSpaceTimer.setInterval(s_storageSpaceDelay);
+    connect(&m_storageSpaceTimer, &QTimer::timeout, this, &SolidDeviceEngine::updateStorageSpaces);
+    connect(m_mountWatcher, &QFileSystemWatcher::directoryChanged, this, &SolidDeviceEngine::scheduleStorageSpaceUpdate);
+
     listenForNewDevices();
     setMinimumPollingInterval(1000);
     connect(this, &Plasma::DataEngine::sourceRemoved,
@@ -171,6 +181,9 @@ bool SolidDeviceEngine::populateDeviceData(const QString &name)
 
         if (storageaccess->isAccessible()) {
             updateStorageSpace(name);
+            if (!storageaccess->filePath().isEmpty()) {
+                m_mountWatcher->addPath(storageaccess->filePath());
+            }
         }
 
         m_signalmanager->mapDevice(storageaccess, device.udi());
@@ -528,6 +541,8 @@ void SolidDeviceEngine::setIdleState(Solid::ErrorType error, QVariant errorData,
 
     setData(udi, I18N_NOOP("Accessible"), storageaccess->isAccessible());
     setData(udi, I18N_NOOP("File Path"), storageaccess->filePath());
+
+    scheduleStorageSpaceUpdate();
 }
 
 void SolidDeviceEngine::deviceChanged(const QMap<QString, int> &props)
@@ -571,7 +586,10 @@ bool SolidDeviceEngine::updateStorageSpace(const QString &udi)
                 [this, timer, path, udi](KIO::Job *job, KIO::filesize_t size, KIO::filesize_t available) {
             timer->stop();
 
-            if (!job->error()) {
+            Plasma::DataContainer *container = containerForSource(udi);
+            if (!job->error() && container
+                && (container->data().value(I18N_NOOP("Free Space")).toULongLong() != available
+                    || container->data().value(I18N_NOOP("Size")).toULongLong() != size)) {
                 setData(udi, I18N_NOOP("Free Space"), QVariant(available));
                 setData(udi, I18N_NOOP("Free Space Text"), KFormat().formatByteSize(available));
                 setData(udi, I18N_NOOP("Size"), QVariant(size));
@@ -587,6 +605,37 @@ bool SolidDeviceEngine::updateStorageSpace(const QString &udi)
     return false;
 }
 
+void SolidDeviceEngine::updateStorageSpaces()
+{
+    QStringList mountPoints;
+    for (auto it = m_devicemap.constBegin(); it != m_devicemap.constEnd(); ++it) {
+        const Solid::StorageAccess *storageaccess = it.value().as<Solid::StorageAccess>();
+        if (storageaccess && storageaccess->isAccessible() && !storageaccess->filePath().isEmpty()) {
+            mountPoints << storageaccess->filePath();
+            updateStorageSpace(it.key());
+        }
+    }
+
+    const QStringList watchedMountPoints = m_mountWatcher->directories();
+    for (const QString &path : watchedMountPoints) {
+        if (!mountPoints.contains(path)) {
+            m_mountWatcher->removePath(path);
+        }
+    }
+    for (const QString &path : qAsConst(mountPoints)) {
+        if (!watchedMountPoints.contains(path)) {
+            m_mountWatcher->addPath(path);
+        }
+    }
+}
+
+void SolidDeviceEngine::scheduleStorageSpaceUpdate()
+{
+    if (!m_storageSpaceTimer.isActive()) {
+        m_storageSpaceTimer.start();
+    }
+}
+
 bool SolidDeviceEngine::updateHardDiskTemperature(const QString &udi)
 {
     Solid::Device device = m_devicemap.value(udi);
@@ -658,6 +707,7 @@ bool SolidDeviceEngine::updateInUse(const QString &udi)
 
 bool SolidDeviceEngine::updateSourceEvent(const QString& source)
 {
+    //besides polling, free space is sampled for all devices on mounts and changes, see updateStorageSpaces()
     bool update1 = updateStorageSpace(source);
     bool update2 = updateHardDiskTemperature(source);
     bool update3 = updateEmblems(source);
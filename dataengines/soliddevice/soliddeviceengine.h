@@ -24,6 +24,7 @@
 #include <QList>
 #include <QMap>
 #include <QPair>
+#include <QTimer>
 
 #include <solid/devicenotifier.h>
 #include <solid/device.h>
@@ -37,6 +38,8 @@
 #include "hddtemp.h"
 #include <KIO/FileSystemFreeSpaceJob>
 
+class QFileSystemWatcher;
+
 enum State {
     Idle = 0,
     Mounting = 1,
@@ -69,6 +72,8 @@ protected:
 private:
     bool populateDeviceData(const QString &name);
     bool updateStorageSpace(const QString &udi);
+    void updateStorageSpaces();
+    void scheduleStorageSpaceUpdate();
     bool updateHardDiskTemperature(const QString &udi);
     bool updateEmblems(const QString &udi);
     bool updateInUse(const QString &udi);
@@ -83,6 +88,10 @@ private:
     QMap<QString, QString> m_encryptedContainerMap;
     //path, for pending file system free space jobs
     QSet<QString> m_paths;
+    //free space of all mounted devices is sampled together, after mounts and changes
+    QTimer m_storageSpaceTimer;
+    //mount points, changes at their top level hint that free space changed
+    QFileSystemWatcher *m_mountWatcher;
     DeviceSignalMapManager *m_signalmanager;
 
     HddTemp *m_temperature;
@@ -20,6 +20,9 @@
  ***************************************************************************/
 
 #include "statusnotifieritem_engine.h"
+#include <QDBusMetaType>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
 #include <QStringList>
 #include "statusnotifieritemsource.h"
 
@@ -29,12 +32,15 @@
 #include <iostream>
 
 static const QString s_watcherServiceName(QStringLiteral("org.kde.StatusNotifierWatcher"));
+static const QString s_watcherPath(QStringLiteral("/StatusNotifierWatcher"));
+static const QString s_itemCacheInterface(QStringLiteral("org.kde.StatusNotifierItemCache"));
 
 StatusNotifierItemEngine::StatusNotifierItemEngine(QObject *parent, const QVariantList& args)
     : Plasma::DataEngine(parent, args),
       m_statusNotifierWatcher(nullptr)
 {
     Q_UNUSED(args);
+    qDBusRegisterMetaType<KDbusItemPropertiesMap>();
     init();
 }
 
@@ -90,28 +96,39 @@ void StatusNotifierItemEngine::registerWatcher(const QString& service)
     if (service == s_watcherServiceName) {
         delete m_statusNotifierWatcher;
 
-        m_statusNotifierWatcher = new org::kde::StatusNotifierWatcher(s_watcherServiceName, QStringLiteral("/StatusNotifierWatcher"),
+        m_statusNotifierWatcher = new org::kde::StatusNotifierWatcher(s_watcherServiceName, s_watcherPath,
 								      QDBusConnection::sessionBus());
         if (m_statusNotifierWatcher->isValid()) {
             m_statusNotifierWatcher->call(QDBus::NoBlock, QStringLiteral("RegisterStatusNotifierHost"), m_serviceName);
 
-            OrgFreedesktopDBusPropertiesInterface  propetriesIface(m_statusNotifierWatcher->service(), m_statusNotifierWatcher->path(), m_statusNotifierWatcher->connection());
-
-            QDBusPendingReply<QDBusVariant> pendingItems = propetriesIface.Get(m_statusNotifierWatcher->interface(), "RegisteredStatusNotifierItems");
+            connect(m_statusNotifierWatcher, &OrgKdeStatusNotifierWatcherInterface::StatusNotifierItemUnregistered, this, &StatusNotifierItemEngine::serviceUnregistered);
 
-            QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingItems, this);
-            connect(watcher, &QDBusPendingCallWatcher::finished, this, [=]() {
-                watcher->deleteLater();
-                QDBusReply<QDBusVariant> reply = *watcher;
-                QStringList registeredItems = reply.value().variant().toStringList();
-                foreach (const QString &service, registeredItems) {
-                    newItem(service);
+            // Our watcher has the properties of every item already: get them all in one message and
+            // let it tell us about changes, rather than asking every item. Connect first so no change is missed
+            QDBusConnection::sessionBus().connect(s_watcherServiceName, s_watcherPath, s_itemCacheInterface, QStringLiteral("StatusNotifierItemsChanged"),
+                                                  this, SLOT(itemsChanged(KDbusItemPropertiesMap)));
+
+            QDBusMessage message = QDBusMessage::createMethodCall(s_watcherServiceName, s_watcherPath, s_itemCacheInterface,
+                                                                  QStringLiteral("GetRegisteredItemsWithProperties"));
+            QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(message), this);
+            connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *call) {
+                call->deleteLater();
+                if (!m_statusNotifierWatcher) {
+                    return;
                 }
-            });
 
-            connect(m_statusNotifierWatcher, &OrgKdeStatusNotifierWatcherInterface::StatusNotifierItemRegistered, this, &StatusNotifierItemEngine::serviceRegistered);
-            connect(m_statusNotifierWatcher, &OrgKdeStatusNotifierWatcherInterface::StatusNotifierItemUnregistered, this, &StatusNotifierItemEngine::serviceUnregistered);
+                QDBusPendingReply<KDbusItemPropertiesMap> reply = *call;
+                if (reply.isError()) {
+                    // Other watchers only know the item ids
+                    QDBusConnection::sessionBus().disconnect(s_watcherServiceName, s_watcherPath, s_itemCacheInterface, QStringLiteral("StatusNotifierItemsChanged"),
+                                                             this, SLOT(itemsChanged(KDbusItemPropertiesMap)));
+                    connect(m_statusNotifierWatcher, &OrgKdeStatusNotifierWatcherInterface::StatusNotifierItemRegistered, this, &StatusNotifierItemEngine::serviceRegistered);
+                    fetchRegisteredItems();
+                    return;
+                }
 
+                itemsChanged(reply.value());
+            });
         } else {
             delete m_statusNotifierWatcher;
             m_statusNotifierWatcher = nullptr;
@@ -127,6 +144,8 @@ void StatusNotifierItemEngine::unregisterWatcher(const QString& service)
 
         disconnect(m_statusNotifierWatcher, &OrgKdeStatusNotifierWatcherInterface::StatusNotifierItemRegistered, this, &StatusNotifierItemEngine::serviceRegistered);
         disconnect(m_statusNotifierWatcher, &OrgKdeStatusNotifierWatcherInterface::StatusNotifierItemUnregistered, this, &StatusNotifierItemEngine::serviceUnregistered);
+        QDBusConnection::sessionBus().disconnect(s_watcherServiceName, s_watcherPath, s_itemCacheInterface, QStringLiteral("StatusNotifierItemsChanged"),
+                                                 this, SLOT(itemsChanged(KDbusItemPropertiesMap)));
 
         removeAllSources();
 
@@ -135,6 +154,25 @@ void StatusNotifierItemEngine::unregisterWatcher(const QString& service)
     }
 }
 
+void StatusNotifierItemEngine::fetchRegisteredItems()
+{
+    OrgFreedesktopDBusPropertiesInterface  propetriesIface(m_statusNotifierWatcher->service(), m_statusNotifierWatcher->path(), m_statusNotifierWatcher->connection());
+
+    QDBusPendingReply<QDBusVariant> pendingItems = propetriesIface.Get(m_statusNotifierWatcher->interface(), "RegisteredStatusNotifierItems");
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingItems, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [=]() {
+        watcher->deleteLater();
+        QDBusReply<QDBusVariant> reply = *watcher;
+        QStringList registeredItems = reply.value().variant().toStringList();
+        foreach (const QString &service, registeredItems) {
+            if (!containerForSource(service)) {
+                newItem(service);
+            }
+        }
+    });
+}
+
 void StatusNotifierItemEngine::serviceRegistered(const QString &service)
 {
     qCDebug(DATAENGINE_SNI) << "Registering"<<service;
@@ -148,10 +186,24 @@ void StatusNotifierItemEngine::serviceUnregistered(const QString &service)
 
 void StatusNotifierItemEngine::newItem(const QString &service)
 {
-    StatusNotifierItemSource *itemSource = new StatusNotifierItemSource(service, this);
+    StatusNotifierItemSource *itemSource = new StatusNotifierItemSource(service, false, this);
     addSource(itemSource);
 }
 
+void StatusNotifierItemEngine::itemsChanged(const KDbusItemPropertiesMap &items)
+{
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        StatusNotifierItemSource *source = qobject_cast<StatusNotifierItemSource *>(containerForSource(it.key()));
+        if (source) {
+            source->setProperties(it.value());
+        } else {
+            source = new StatusNotifierItemSource(it.key(), true, this);
+            source->setProperties(it.value());
+            addSource(source);
+        }
+    }
+}
+
 K_EXPORT_PLASMA_DATAENGINE_WITH_JSON(statusnotifieritem, StatusNotifierItemEngine,"plasma-dataengine-statusnotifieritem.json")
 
 #include "statusnotifieritem_engine.moc"
@@ -23,6 +23,7 @@
 #define STATUSNOTIFIERITEM_ENGINE_H
 
 #include "statusnotifierwatcher_interface.h"
+#include "systemtraytypes.h"
 #include <Plasma/DataEngine>
 #include <Plasma/Service>
 #include <QDBusConnection>
@@ -40,6 +41,7 @@ protected:
 
     virtual void init();
     void newItem(const QString &service);
+    void fetchRegisteredItems();
 
 protected Q_SLOTS:
     void serviceChange(const QString& name,
@@ -49,6 +51,7 @@ protected Q_SLOTS:
     void unregisterWatcher(const QString& service);
     void serviceRegistered(const QString &service);
     void serviceUnregistered(const QString &service);
+    void itemsChanged(const KDbusItemPropertiesMap &items);
 
 private:
     org::kde::StatusNotifierWatcher *m_statusNotifierWatcher;
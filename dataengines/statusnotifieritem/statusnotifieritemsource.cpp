@@ -24,6 +24,7 @@
 #include "statusnotifieritemservice.h"
 
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QIcon>
 #include <QDebug>
 #include <KIconEngine>
@@ -36,9 +37,9 @@
 #include <QImage>
 #include <QMenu>
 #include <QPixmap>
+#include <QPixmapCache>
 #include <QSysInfo>
-
-#include <netinet/in.h>
+#include <QtEndian>
 
 #include <dbusmenuimporter.h>
 
@@ -60,16 +61,14 @@ private:
     KIconLoader *m_iconLoader;
 };
 
-StatusNotifierItemSource::StatusNotifierItemSource(const QString &notifierItemId, QObject *parent)
+StatusNotifierItemSource::StatusNotifierItemSource(const QString &notifierItemId, bool cachedByWatcher, QObject *parent)
     : Plasma::DataContainer(parent),
       m_customIconLoader(nullptr),
       m_menuImporter(nullptr),
+      m_pendingGets(0),
       m_refreshing(false),
       m_needsReRefreshing(false),
-      m_titleUpdate(true),
-      m_iconUpdate(true),
-      m_tooltipUpdate(true),
-      m_statusUpdate(true)
+      m_fetchedAll(false)
 {
     setObjectName(notifierItemId);
     qDBusRegisterMetaType<KDbusImageStruct>();
@@ -126,11 +125,12 @@ StatusNotifierItemSource::StatusNotifierItemSource(const QString &notifierItemId
     connect(&m_refreshTimer, &QTimer::timeout, this, &StatusNotifierItemSource::performRefresh);
 
     m_valid = !service.isEmpty() && m_statusNotifierItemInterface->isValid();
-    if (m_valid) {
+    // Otherwise the engine passes on what the watcher fetched for us through setProperties()
+    if (m_valid && !cachedByWatcher) {
         connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewTitle, this, &StatusNotifierItemSource::refreshTitle);
         connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewIcon, this, &StatusNotifierItemSource::refreshIcons);
-        connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewAttentionIcon, this, &StatusNotifierItemSource::refreshIcons);
-        connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewOverlayIcon, this, &StatusNotifierItemSource::refreshIcons);
+        connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewAttentionIcon, this, &StatusNotifierItemSource::refreshAttentionIcon);
+        connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewOverlayIcon, this, &StatusNotifierItemSource::refreshOverlayIcon);
         connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewToolTip, this, &StatusNotifierItemSource::refreshToolTip);
         connect(m_statusNotifierItemInterface, &OrgKdeStatusNotifierItem::NewStatus, this, &StatusNotifierItemSource::syncStatus);
         refresh();
@@ -154,6 +154,8 @@ Plasma::Service *StatusNotifierItemSource::createService()
 
 void StatusNotifierItemSource::syncStatus(QString status)
 {
+    m_properties.insert(QStringLiteral("Status"), status);
+
     setData(QStringLiteral("TitleChanged"), false);
     setData(QStringLiteral("IconsChanged"), false);
     setData(QStringLiteral("TooltipChanged"), false);
@@ -164,19 +166,32 @@ void StatusNotifierItemSource::syncStatus(QString status)
 
 void StatusNotifierItemSource::refreshTitle()
 {
-    m_titleUpdate = true;
+    m_pendingProperties << QStringLiteral("Title");
     refresh();
 }
 
 void StatusNotifierItemSource::refreshIcons()
 {
-    m_iconUpdate = true;
+    m_pendingProperties << QStringLiteral("IconThemePath") << QStringLiteral("IconName") << QStringLiteral("IconPixmap");
+    refresh();
+}
+
+void StatusNotifierItemSource::refreshAttentionIcon()
+{
+    m_pendingProperties << QStringLiteral("IconThemePath") << QStringLiteral("AttentionIconName")
+                        << QStringLiteral("AttentionIconPixmap") << QStringLiteral("AttentionMovieName");
+    refresh();
+}
+
+void StatusNotifierItemSource::refreshOverlayIcon()
+{
+    m_pendingProperties << QStringLiteral("IconThemePath") << QStringLiteral("OverlayIconName") << QStringLiteral("OverlayIconPixmap");
     refresh();
 }
 
 void StatusNotifierItemSource::refreshToolTip()
 {
-    m_tooltipUpdate = true;
+    m_pendingProperties << QStringLiteral("ToolTip");
     refresh();
 }
 
@@ -195,13 +210,63 @@ void StatusNotifierItemSource::performRefresh()
     }
 
     m_refreshing = true;
-    QDBusMessage message = QDBusMessage::createMethodCall(m_statusNotifierItemInterface->service(),
-                                                          m_statusNotifierItemInterface->path(), QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("GetAll"));
 
-    message << m_statusNotifierItemInterface->interface();
-    QDBusPendingCall call = m_statusNotifierItemInterface->connection().asyncCall(message);
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
-    connect(watcher, &QDBusPendingCallWatcher::finished, this, &StatusNotifierItemSource::refreshCallback);
+    // Everything until that worked once, afterwards only what the item told us has changed
+    if (!m_fetchedAll) {
+        m_pendingProperties.clear();
+
+        QDBusMessage message = QDBusMessage::createMethodCall(m_statusNotifierItemInterface->service(),
+                                                              m_statusNotifierItemInterface->path(), QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("GetAll"));
+
+        message << m_statusNotifierItemInterface->interface();
+        QDBusPendingCall call = m_statusNotifierItemInterface->connection().asyncCall(message);
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, &StatusNotifierItemSource::refreshCallback);
+        return;
+    }
+
+    m_fetchingProperties = m_pendingProperties;
+    m_pendingProperties.clear();
+    m_pendingGets = m_fetchingProperties.count();
+
+    if (m_pendingGets == 0) {
+        m_refreshing = false;
+        return;
+    }
+
+    for (const QString &property : qAsConst(m_fetchingProperties)) {
+        QDBusMessage message = QDBusMessage::createMethodCall(m_statusNotifierItemInterface->service(),
+                                                              m_statusNotifierItemInterface->path(), QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("Get"));
+
+        message << m_statusNotifierItemInterface->interface() << property;
+        QDBusPendingCall call = m_statusNotifierItemInterface->connection().asyncCall(message);
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, property](QDBusPendingCallWatcher *call) {
+            propertyCallback(property, call);
+        });
+    }
+}
+
+// QDBusArguments can only be read once, keep the demarshalled values around instead
+static QVariant demarshalledProperty(const QString &name, const QVariant &value)
+{
+    if (value.userType() != qMetaTypeId<QDBusArgument>()) {
+        return value;
+    }
+
+    const QDBusArgument argument = value.value<QDBusArgument>();
+
+    if (name == QLatin1String("ToolTip")) {
+        KDbusToolTipStruct toolTip;
+        argument >> toolTip;
+        return QVariant::fromValue(toolTip);
+    } else if (name.endsWith(QLatin1String("Pixmap"))) {
+        KDbusImageVector image;
+        argument >> image;
+        return QVariant::fromValue(image);
+    }
+
+    return value;
 }
 
 /**
@@ -210,30 +275,95 @@ void StatusNotifierItemSource::performRefresh()
 void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
 {
     m_refreshing = false;
+
+    QDBusPendingReply<QVariantMap> reply = *call;
+    if (reply.isError()) {
+        m_valid = false;
+    } else {
+        const QVariantMap properties = reply.argumentAt<0>();
+        for (auto it = properties.constBegin(); it != properties.constEnd(); ++it) {
+            m_properties.insert(it.key(), demarshalledProperty(it.key(), it.value()));
+        }
+        m_fetchedAll = true;
+
+        updateData(QSet<QString>(), true);
+    }
+
+    checkForUpdate();
+    call->deleteLater();
+
     if (m_needsReRefreshing) {
         m_needsReRefreshing = false;
         performRefresh();
-        call->deleteLater();
-        return;
     }
+}
 
-    QDBusPendingReply<QVariantMap> reply = *call;
+void StatusNotifierItemSource::setProperties(const QVariantMap &properties)
+{
+    // The watcher hands out all properties of an item the first time
+    const bool all = !m_fetchedAll;
+    m_fetchedAll = true;
+
+    QSet<QString> changedProperties;
+    for (auto it = properties.constBegin(); it != properties.constEnd(); ++it) {
+        m_properties.insert(it.key(), demarshalledProperty(it.key(), it.value()));
+        changedProperties.insert(it.key());
+    }
+
+    updateData(changedProperties, all);
+    checkForUpdate();
+}
+
+void StatusNotifierItemSource::propertyCallback(const QString &property, QDBusPendingCallWatcher *call)
+{
+    QDBusPendingReply<QDBusVariant> reply = *call;
     if (reply.isError()) {
-        m_valid = false;
+        // Optional properties may not be implemented at all
+        m_properties.remove(property);
     } else {
-        // record what has changed
-        setData(QStringLiteral("TitleChanged"), m_titleUpdate);
-        m_titleUpdate = false;
-        setData(QStringLiteral("IconsChanged"), m_iconUpdate);
-        m_iconUpdate = false;
-        setData(QStringLiteral("ToolTipChanged"), m_tooltipUpdate);
-        m_tooltipUpdate = false;
-        setData(QStringLiteral("StatusChanged"), m_statusUpdate);
-        m_statusUpdate = false;
-
-        //IconThemePath (handle this one first, because it has an impact on
-        //others)
-        QVariantMap properties = reply.argumentAt<0>();
+        m_properties.insert(property, demarshalledProperty(property, reply.value().variant()));
+    }
+    call->deleteLater();
+
+    if (--m_pendingGets > 0) {
+        return;
+    }
+
+    m_refreshing = false;
+    updateData(m_fetchingProperties, false);
+    m_fetchingProperties.clear();
+    checkForUpdate();
+
+    if (m_needsReRefreshing) {
+        m_needsReRefreshing = false;
+        performRefresh();
+    }
+}
+
+void StatusNotifierItemSource::updateData(const QSet<QString> &changedProperties, bool all)
+{
+    static const QSet<QString> iconProperties {
+        QStringLiteral("IconThemePath"),
+        QStringLiteral("IconName"), QStringLiteral("IconPixmap"),
+        QStringLiteral("OverlayIconName"), QStringLiteral("OverlayIconPixmap"),
+        QStringLiteral("AttentionIconName"), QStringLiteral("AttentionIconPixmap"), QStringLiteral("AttentionMovieName")
+    };
+
+    const bool titleChanged = all || changedProperties.contains(QStringLiteral("Title"));
+    const bool iconsChanged = all || changedProperties.intersects(iconProperties);
+    const bool toolTipChanged = all || changedProperties.contains(QStringLiteral("ToolTip"));
+
+    // record what has changed
+    setData(QStringLiteral("TitleChanged"), titleChanged);
+    setData(QStringLiteral("IconsChanged"), iconsChanged);
+    setData(QStringLiteral("ToolTipChanged"), toolTipChanged);
+    setData(QStringLiteral("StatusChanged"), all || changedProperties.contains(QStringLiteral("Status")));
+
+    const QVariantMap &properties = m_properties;
+
+    //IconThemePath (handle this one first, because it has an impact on
+    //others)
+    if (iconsChanged) {
         QString path = properties[QStringLiteral("IconThemePath")].toString();
 
         if (!path.isEmpty() && path != data()[QStringLiteral("IconThemePath")].toString()) {
@@ -255,14 +385,16 @@ void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
             m_customIconLoader->addAppDir(appName.size() ? appName : QStringLiteral("unused"), path);
         }
         setData(QStringLiteral("IconThemePath"), path);
+    }
 
-        setData(QStringLiteral("Category"), properties[QStringLiteral("Category")]);
-        setData(QStringLiteral("Status"), properties[QStringLiteral("Status")]);
-        setData(QStringLiteral("Title"), properties[QStringLiteral("Title")]);
-        setData(QStringLiteral("Id"), properties[QStringLiteral("Id")]);
-        setData(QStringLiteral("WindowId"), properties[QStringLiteral("WindowId")]);
-        setData(QStringLiteral("ItemIsMenu"), properties[QStringLiteral("ItemIsMenu")]);
+    setData(QStringLiteral("Category"), properties[QStringLiteral("Category")]);
+    setData(QStringLiteral("Status"), properties[QStringLiteral("Status")]);
+    setData(QStringLiteral("Title"), properties[QStringLiteral("Title")]);
+    setData(QStringLiteral("Id"), properties[QStringLiteral("Id")]);
+    setData(QStringLiteral("WindowId"), properties[QStringLiteral("WindowId")]);
+    setData(QStringLiteral("ItemIsMenu"), properties[QStringLiteral("ItemIsMenu")]);
 
+    if (iconsChanged) {
         //Attention Movie
         setData(QStringLiteral("AttentionMovieName"), properties[QStringLiteral("AttentionMovieName")]);
 
@@ -275,7 +407,7 @@ void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
             QIcon icon;
             QString iconName;
 
-            properties[QStringLiteral("OverlayIconPixmap")].value<QDBusArgument>() >> image;
+            image = properties[QStringLiteral("OverlayIconPixmap")].value<KDbusImageVector>();
             if (image.isEmpty()) {
                 QString iconName = properties[QStringLiteral("OverlayIconName")].toString();
                 setData(QStringLiteral("OverlayIconName"), iconName);
@@ -287,7 +419,7 @@ void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
                 overlay = imageVectorToPixmap(image);
             }
 
-            properties[QStringLiteral("IconPixmap")].value<QDBusArgument>() >> image;
+            image = properties[QStringLiteral("IconPixmap")].value<KDbusImageVector>();
             if (image.isEmpty()) {
                 iconName = properties[QStringLiteral("IconName")].toString();
                 if (!iconName.isEmpty()) {
@@ -312,7 +444,7 @@ void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
             KDbusImageVector image;
             QIcon attentionIcon;
 
-            properties[QStringLiteral("AttentionIconPixmap")].value<QDBusArgument>() >> image;
+            image = properties[QStringLiteral("AttentionIconPixmap")].value<KDbusImageVector>();
             if (image.isEmpty()) {
                 QString iconName = properties[QStringLiteral("AttentionIconName")].toString();
                 setData(QStringLiteral("AttentionIconName"), iconName);
@@ -331,55 +463,51 @@ void StatusNotifierItemSource::refreshCallback(QDBusPendingCallWatcher *call)
             }
             setData(QStringLiteral("AttentionIcon"), attentionIcon.isNull() ? QVariant() : attentionIcon);
         }
+    }
 
-        //ToolTip
-        {
-            KDbusToolTipStruct toolTip;
-            properties[QStringLiteral("ToolTip")].value<QDBusArgument>() >> toolTip;
-            if (toolTip.title.isEmpty()) {
-                setData(QStringLiteral("ToolTipTitle"), QString());
-                setData(QStringLiteral("ToolTipSubTitle"), QString());
+    //ToolTip
+    if (toolTipChanged) {
+        const KDbusToolTipStruct toolTip = properties[QStringLiteral("ToolTip")].value<KDbusToolTipStruct>();
+        if (toolTip.title.isEmpty()) {
+            setData(QStringLiteral("ToolTipTitle"), QString());
+            setData(QStringLiteral("ToolTipSubTitle"), QString());
+            setData(QStringLiteral("ToolTipIcon"), QString());
+        } else {
+            QIcon toolTipIcon;
+            if (toolTip.image.size() == 0) {
+                toolTipIcon = QIcon(new KIconEngine(toolTip.icon, iconLoader()));
+            } else {
+                toolTipIcon = imageVectorToPixmap(toolTip.image);
+            }
+            setData(QStringLiteral("ToolTipTitle"), toolTip.title);
+            setData(QStringLiteral("ToolTipSubTitle"), toolTip.subTitle);
+            if (toolTipIcon.isNull() || toolTipIcon.availableSizes().isEmpty()) {
                 setData(QStringLiteral("ToolTipIcon"), QString());
             } else {
-                QIcon toolTipIcon;
-                if (toolTip.image.size() == 0) {
-                    toolTipIcon = QIcon(new KIconEngine(toolTip.icon, iconLoader()));
-                } else {
-                    toolTipIcon = imageVectorToPixmap(toolTip.image);
-                }
-                setData(QStringLiteral("ToolTipTitle"), toolTip.title);
-                setData(QStringLiteral("ToolTipSubTitle"), toolTip.subTitle);
-                if (toolTipIcon.isNull() || toolTipIcon.availableSizes().isEmpty()) {
-                    setData(QStringLiteral("ToolTipIcon"), QString());
-                } else {
-                    setData(QStringLiteral("ToolTipIcon"), toolTipIcon);
-                }
+                setData(QStringLiteral("ToolTipIcon"), toolTipIcon);
             }
         }
+    }
 
-        //Menu
-        if (!m_menuImporter) {
-            QString menuObjectPath = properties[QStringLiteral("Menu")].value<QDBusObjectPath>().path();
-            if (!menuObjectPath.isEmpty()) {
-                if (menuObjectPath == QLatin1String("/NO_DBUSMENU")) {
-                    // This is a hack to make it possible to disable DBusMenu in an
-                    // application. The string "/NO_DBUSMENU" must be the same as in
-                    // KStatusNotifierItem::setContextMenu().
-                    qWarning() << "DBusMenu disabled for this application";
-                } else {
-                    m_menuImporter = new PlasmaDBusMenuImporter(m_statusNotifierItemInterface->service(), menuObjectPath, iconLoader(), this);
-                    connect(m_menuImporter, &PlasmaDBusMenuImporter::menuUpdated, this, [this](QMenu *menu) {
-                        if (menu == m_menuImporter->menu()) {
-                            contextMenuReady();
-                        }
-                    });
-                }
+    //Menu
+    if (!m_menuImporter) {
+        QString menuObjectPath = properties[QStringLiteral("Menu")].value<QDBusObjectPath>().path();
+        if (!menuObjectPath.isEmpty()) {
+            if (menuObjectPath == QLatin1String("/NO_DBUSMENU")) {
+                // This is a hack to make it possible to disable DBusMenu in an
+                // application. The string "/NO_DBUSMENU" must be the same as in
+                // KStatusNotifierItem::setContextMenu().
+                qWarning() << "DBusMenu disabled for this application";
+            } else {
+                m_menuImporter = new PlasmaDBusMenuImporter(m_statusNotifierItemInterface->service(), menuObjectPath, iconLoader(), this);
+                connect(m_menuImporter, &PlasmaDBusMenuImporter::menuUpdated, this, [this](QMenu *menu) {
+                    if (menu == m_menuImporter->menu()) {
+                        contextMenuReady();
+                    }
+                });
             }
         }
     }
-
-    checkForUpdate();
-    call->deleteLater();
 }
 
 void StatusNotifierItemSource::contextMenuReady()
@@ -389,29 +517,30 @@ void StatusNotifierItemSource::contextMenuReady()
 
 QPixmap StatusNotifierItemSource::KDbusImageStructToPixmap(const KDbusImageStruct &image) const
 {
-    //swap from network byte order if we are little endian
-    if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
-        uint *uintBuf = (uint *) image.data.data();
-        for (uint i = 0; i < image.data.size()/sizeof(uint); ++i) {
-            *uintBuf = ntohl(*uintBuf);
-            ++uintBuf;
-        }
-    }
-    if (image.width == 0 || image.height == 0) {
+    if (image.width <= 0 || image.height <= 0 || image.data.size() < image.width * image.height * 4) {
         return QPixmap();
     }
 
-    //avoid a deep copy of the image data
-    //we need to keep a reference to the image.data alive for the lifespan of the image, even if the image is copied
-    //we create a new QByteArray with a shallow copy of the original data on the heap, then delete this in the QImage cleanup
-    auto dataRef = new QByteArray(image.data);
-
-    QImage iconImage(reinterpret_cast<const uchar*>(dataRef->data()), image.width, image.height, QImage::Format_ARGB32,
-            [](void* ptr) {
-                delete static_cast<QByteArray*>(ptr);
-            },
-            dataRef);
-    return QPixmap::fromImage(iconImage);
+    //the pixmap cache is shared by the whole process, blinking frames and
+    //items of other hosts showing the same image reuse the decoded pixmap
+    const QString key = QLatin1String("statusnotifieritem-")
+                      + QString::fromLatin1(QCryptographicHash::hash(image.data, QCryptographicHash::Md5).toHex())
+                      + QLatin1Char('-') + QString::number(image.width) + QLatin1Char('x') + QString::number(image.height);
+
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap)) {
+        return pixmap;
+    }
+
+    //convert from network byte order while copying into the image,
+    //Qt swaps whole arrays with SIMD where the CPU supports it
+    QImage iconImage(image.width, image.height, QImage::Format_ARGB32);
+    qFromBigEndian<quint32>(image.data.constData(), image.width * image.height, iconImage.bits());
+
+    pixmap = QPixmap::fromImage(iconImage);
+    QPixmapCache::insert(key, pixmap);
+
+    return pixmap;
 }
 
 QIcon StatusNotifierItemSource::imageVectorToPixmap(const KDbusImageVector &vector) const
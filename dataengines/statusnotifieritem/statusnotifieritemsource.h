@@ -25,7 +25,10 @@
 #include <Plasma/DataContainer>
 #include <QString>
 #include <QDBusPendingCallWatcher>
+#include <QIcon>
 #include <QMenu>
+#include <QSet>
+#include <QVariantMap>
 
 #include "statusnotifieritem_interface.h"
 
@@ -39,10 +42,19 @@ class StatusNotifierItemSource : public Plasma::DataContainer
     Q_OBJECT
 
 public:
-    StatusNotifierItemSource(const QString &service, QObject *parent);
+    /**
+     * When cachedByWatcher is true the source doesn't talk to the item to know
+     * its properties, they have to be handed over with setProperties()
+     */
+    StatusNotifierItemSource(const QString &service, bool cachedByWatcher, QObject *parent);
     ~StatusNotifierItemSource() override;
     Plasma::Service *createService();
 
+    /**
+     * Updates the given properties, as fetched from the item
+     */
+    void setProperties(const QVariantMap &properties);
+
     void activate(int x, int y);
     void secondaryActivate(int x, int y);
     void scroll(int delta, const QString &direction);
@@ -56,15 +68,19 @@ private Q_SLOTS:
     void contextMenuReady();
     void refreshTitle();
     void refreshIcons();
+    void refreshAttentionIcon();
+    void refreshOverlayIcon();
     void refreshToolTip();
     void refresh();
     void performRefresh();
     void syncStatus(QString);
     void refreshCallback(QDBusPendingCallWatcher *);
+    void propertyCallback(const QString &property, QDBusPendingCallWatcher *call);
     void activateCallback(QDBusPendingCallWatcher *);
 
 private:
 
+    void updateData(const QSet<QString> &changedProperties, bool all);
     QPixmap KDbusImageStructToPixmap(const KDbusImageStruct &image) const;
     QIcon imageVectorToPixmap(const KDbusImageVector &vector) const;
     void overlayIcon(QIcon *icon, QIcon *overlay);
@@ -77,12 +93,15 @@ private:
     KIconLoader *m_customIconLoader;
     DBusMenuImporter *m_menuImporter;
     org::kde::StatusNotifierItem *m_statusNotifierItemInterface;
+    // Last known value of every property of the item, pixmaps and tooltip demarshalled
+    QVariantMap m_properties;
+    QSet<QString> m_pendingProperties;
+    QSet<QString> m_fetchingProperties;
+    int m_pendingGets;
     bool m_refreshing : 1;
     bool m_needsReRefreshing : 1;
-    bool m_titleUpdate : 1;
-    bool m_iconUpdate : 1;
-    bool m_tooltipUpdate : 1;
-    bool m_statusUpdate : 1;
+    // Whether m_properties holds all properties, syncStatus may have set some before
+    bool m_fetchedAll : 1;
 };
 
 #endif // STATUSNOTIFIERITEMSOURCE_H
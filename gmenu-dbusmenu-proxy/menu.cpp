@@ -338,9 +338,9 @@ void Menu::actionsChanged(const QStringList &dirtyActions, const QString &prefix
         forEachMenuItem([ &prefixedAction, &dirtyItems](int subscription, int section, int index, const QVariantMap &item) {
             const QString actionName = Utils::itemActionName(item);
 
+            // several items can use the same action, all of them changed
             if (actionName == prefixedAction) {
                 dirtyItems.append(Utils::treeStructureToInt(subscription, section, index));
-                return false; // break
             }
 
             return true; // continue
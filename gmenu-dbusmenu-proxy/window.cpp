@@ -239,13 +239,17 @@ void Window::menuItemsChanged(const QVector<uint> &itemIds)
 
     DBusMenuItemList items;
 
+    for (uint id : itemIds) {
+        invalidateItem(id);
+    }
+
     for (uint id : itemIds) {
         const auto newItem = m_currentMenu->getItem(id);
 
         DBusMenuItem dBusItem{
             // 0 is menu, items start at 1
             static_cast<int>(id),
-            gMenuToDBusMenuProperties(newItem)
+            itemProperties(id, newItem)
         };
         items.append(dBusItem);
     }
@@ -259,6 +263,14 @@ void Window::menuChanged(const QVector<uint> &menuIds)
         return;
     }
 
+    for (uint menu : menuIds) {
+        int subscription;
+        int section;
+        int index;
+        Utils::intToTreeStructure(menu, subscription, section, index);
+        invalidateSection(subscription, section);
+    }
+
     for (uint menu : menuIds) {
         emit LayoutUpdated(3 /*revision*/, menu);
     }
@@ -266,6 +278,9 @@ void Window::menuChanged(const QVector<uint> &menuIds)
 
 void Window::onMenuSubscribed(uint id)
 {
+    // Layouts may have been built while sections they alias weren't loaded yet
+    m_layoutCache.clear();
+
     // When it was a delayed GetLayout request, send the reply now
     const auto pendingReplies = m_pendingGetLayouts.values(id);
     if (!pendingReplies.isEmpty()) {
@@ -382,6 +397,7 @@ void Window::updateWindowProperties()
     }
 
     if (m_currentMenu != oldMenu) {
+        clearCache();
         // update entire menu now
         emit LayoutUpdated(4 /*revision*/, 0);
     }
@@ -419,9 +435,39 @@ void Window::Event(int id, const QString &eventId, const QDBusVariant &data, uin
 
 DBusMenuItemList Window::GetGroupProperties(const QList<int> &ids, const QStringList &propertyNames)
 {
-    Q_UNUSED(ids);
-    Q_UNUSED(propertyNames);
-    return DBusMenuItemList();
+    DBusMenuItemList items;
+
+    if (!m_currentMenu) {
+        return items;
+    }
+
+    for (int id : ids) {
+        int subscription;
+        int section;
+        int index;
+        Utils::intToTreeStructure(id, subscription, section, index);
+
+        // 0 is the menu itself, items start at 1
+        if (index < 1) {
+            continue;
+        }
+
+        const QVariantMap item = m_currentMenu->getItem(id);
+        if (item.isEmpty()) {
+            continue;
+        }
+
+        QVariantMap properties = itemProperties(id, item);
+        if (!propertyNames.isEmpty()) {
+            for (auto it = properties.begin(); it != properties.end();) {
+                it = propertyNames.contains(it.key()) ? it + 1 : properties.erase(it);
+            }
+        }
+
+        items.append(DBusMenuItem{id, properties});
+    }
+
+    return items;
 }
 
 uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &propertyNames, DBusMenuLayoutItem &dbusItem)
@@ -478,6 +524,15 @@ uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &prop
         }
     }
 
+    // Menus are requested again every time they're opened, only translate them again when they changed
+    const auto cachedIt = m_layoutCache.constFind(parentId);
+    if (cachedIt != m_layoutCache.constEnd()) {
+        dbusItem = cachedIt->item;
+        return 1;
+    }
+
+    QSet<int> sections{parentId, Utils::treeStructureToInt(section.id, sectionId, 0)};
+
     dbusItem.id = parentId; // TODO
     dbusItem.properties = {
         {QStringLiteral("children-display"), QStringLiteral("submenu")}
@@ -488,9 +543,10 @@ uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &prop
     const auto itemsToBeAdded = section.items;
     for (const auto &item : itemsToBeAdded) {
 
+        const int childId = Utils::treeStructureToInt(section.id, sectionId, ++count);
         DBusMenuLayoutItem child{
-            Utils::treeStructureToInt(section.id, sectionId, ++count),
-            gMenuToDBusMenuProperties(item),
+            childId,
+            itemProperties(childId, item),
             {} // children
         };
         dbusItem.children.append(child);
@@ -509,6 +565,7 @@ uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &prop
 
             // TODO start subscription if we don't have it
             auto items = m_currentMenu->getSection(gmenuSection.subscription, gmenuSection.menu).items;
+            sections.insert(Utils::treeStructureToInt(originalSubscription, originalMenu, 0));
 
             // Check whether it's an alias to an alias
             // FIXME make generic/recursive
@@ -521,14 +578,16 @@ uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &prop
 
                     originalSubscription = gmenuSection2.subscription;
                     originalMenu = gmenuSection2.menu;
+                    sections.insert(Utils::treeStructureToInt(originalSubscription, originalMenu, 0));
                 }
             }
 
             int aliasedCount = 0;
             for (const auto &aliasedItem : qAsConst(items)) {
+                const int aliasedId = Utils::treeStructureToInt(originalSubscription, originalMenu, ++aliasedCount);
                 DBusMenuLayoutItem aliasedChild{
-                    Utils::treeStructureToInt(originalSubscription, originalMenu, ++aliasedCount),
-                    gMenuToDBusMenuProperties(aliasedItem),
+                    aliasedId,
+                    itemProperties(aliasedId, aliasedItem),
                     {} // children
                 };
                 dbusItem.children.append(aliasedChild);
@@ -536,6 +595,8 @@ uint Window::GetLayout(int parentId, int recursionDepth, const QStringList &prop
         }
     }
 
+    m_layoutCache.insert(parentId, CachedLayout{dbusItem, sections});
+
     // revision, unused in libdbusmenuqt
     return 1;
 }
@@ -558,6 +619,64 @@ uint Window::version() const
     return 4;
 }
 
+QVariantMap Window::itemProperties(int id, const QVariantMap &source)
+{
+    auto it = m_itemPropertiesCache.constFind(id);
+    if (it == m_itemPropertiesCache.constEnd()) {
+        it = m_itemPropertiesCache.insert(id, gMenuToDBusMenuProperties(source));
+    }
+    return *it;
+}
+
+void Window::invalidateItem(int id)
+{
+    m_itemPropertiesCache.remove(id);
+
+    int subscription;
+    int section;
+    int index;
+    Utils::intToTreeStructure(id, subscription, section, index);
+    invalidateLayouts(subscription, section);
+}
+
+void Window::invalidateSection(int subscription, int section)
+{
+    // Items were inserted or removed, the ids of the ones after them changed
+    for (auto it = m_itemPropertiesCache.begin(); it != m_itemPropertiesCache.end();) {
+        int itemSubscription;
+        int itemSection;
+        int index;
+        Utils::intToTreeStructure(it.key(), itemSubscription, itemSection, index);
+
+        if (itemSubscription == subscription && itemSection == section) {
+            it = m_itemPropertiesCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    invalidateLayouts(subscription, section);
+}
+
+void Window::invalidateLayouts(int subscription, int section)
+{
+    const int sectionId = Utils::treeStructureToInt(subscription, section, 0);
+
+    for (auto it = m_layoutCache.begin(); it != m_layoutCache.end();) {
+        if (it->sections.contains(sectionId)) {
+            it = m_layoutCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Window::clearCache()
+{
+    m_layoutCache.clear();
+    m_itemPropertiesCache.clear();
+}
+
 QVariantMap Window::gMenuToDBusMenuProperties(const QVariantMap &source) const
 {
     QVariantMap result;
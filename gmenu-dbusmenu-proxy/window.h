@@ -21,6 +21,8 @@
 
 #include <QObject>
 #include <QDBusContext>
+#include <QHash>
+#include <QSet>
 #include <QString>
 #include <QVector>
 #include <QWindow> // for WId
@@ -110,6 +112,12 @@ private:
     void onMenuSubscribed(uint id);
 
     QVariantMap gMenuToDBusMenuProperties(const QVariantMap &source) const;
+    QVariantMap itemProperties(int id, const QVariantMap &source);
+
+    void invalidateItem(int id);
+    void invalidateSection(int subscription, int section);
+    void invalidateLayouts(int subscription, int section);
+    void clearCache();
 
     WId m_winId = 0;
     QString m_serviceName; // original GMenu service (the gtk app)
@@ -126,6 +134,16 @@ private:
 
     QHash<int, QDBusMessage> m_pendingGetLayouts;
 
+    // Translated DBusMenu layouts of the current menu by parent id, with the
+    // sections (id with index 0) they were built from so they can be invalidated
+    struct CachedLayout {
+        DBusMenuLayoutItem item;
+        QSet<int> sections;
+    };
+    QHash<int, CachedLayout> m_layoutCache;
+    // Translated DBusMenu properties of the current menu's items by id
+    QHash<int, QVariantMap> m_itemPropertiesCache;
+
     Menu *m_applicationMenu = nullptr;
     Menu *m_menuBar = nullptr;
 
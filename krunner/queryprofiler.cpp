@@ -0,0 +1,324 @@
+/*
+ *  Copyright 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "queryprofiler.h"
+#include "debug.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaProperty>
+
+#include <KRunner/AbstractRunner>
+#include <KRunner/RunnerManager>
+
+#include <algorithm>
+
+// Latencies kept for each runner
+static const int s_samples = 100;
+// Below this many samples the percentiles say too little to judge a runner
+static const int s_minimumSamples = 5;
+
+int QueryProfiler::RunnerStatistics::percentile(int percent) const
+{
+    if (latencies.isEmpty()) {
+        return -1;
+    }
+
+    QVector<int> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+
+    // Nearest rank
+    const int rank = (percent * sorted.count() + 99) / 100;
+    return sorted.at(qBound(0, rank - 1, sorted.count() - 1));
+}
+
+QueryProfiler::QueryProfiler(QObject *parent)
+    : QObject(parent)
+{
+    m_clock.start();
+}
+
+QueryProfiler::~QueryProfiler()
+{
+}
+
+void QueryProfiler::attach(Plasma::RunnerManager *manager)
+{
+    if (m_managers.contains(manager)) {
+        return;
+    }
+    m_managers.insert(manager);
+
+    connect(manager, &QObject::destroyed, this, [this, manager]() {
+        m_managers.remove(manager);
+    });
+    connect(manager, &Plasma::RunnerManager::matchesChanged, this, [this, manager](const QList<Plasma::QueryMatch> &matches) {
+        matchesChanged(manager, matches);
+    });
+    connect(manager, &Plasma::RunnerManager::queryFinished, this, [this, manager]() {
+        if (manager->query().isEmpty()) {
+            return;
+        }
+        if (manager != m_manager || manager->query() != m_query) {
+            // Nobody had anything for this query
+            startQuery(manager);
+        }
+        finishQuery(true);
+    });
+}
+
+void QueryProfiler::watch(QObject *root)
+{
+    if (!root) {
+        return;
+    }
+
+    const QMetaMethod queryStringChangedSlot = metaObject()->method(metaObject()->indexOfSlot("queryStringChanged()"));
+
+    QList<QObject *> objects = root->findChildren<QObject *>();
+    objects.prepend(root);
+    for (QObject *object : qAsConst(objects)) {
+        if (auto manager = qobject_cast<Plasma::RunnerManager *>(object)) {
+            attach(manager);
+            continue;
+        }
+
+        const int index = object->metaObject()->indexOfProperty("queryString");
+        if (index < 0) {
+            continue;
+        }
+        const QMetaProperty property = object->metaObject()->property(index);
+        if (property.hasNotifySignal()) {
+            connect(object, property.notifySignal(), this, queryStringChangedSlot, Qt::UniqueConnection);
+            connect(object, &QObject::destroyed, this, [this, object]() {
+                m_attachedQueryObjects.remove(object);
+            });
+        }
+    }
+}
+
+void QueryProfiler::queryStringChanged()
+{
+    QObject *object = sender();
+    if (!object) {
+        return;
+    }
+
+    // Models may only create their manager for the first query
+    if (!m_attachedQueryObjects.contains(object)) {
+        const auto managers = object->findChildren<Plasma::RunnerManager *>();
+        for (Plasma::RunnerManager *manager : managers) {
+            attach(manager);
+        }
+        if (!managers.isEmpty()) {
+            m_attachedQueryObjects.insert(object);
+        }
+    }
+
+    // The latencies of the next query are measured from now
+    m_lastInput = m_clock.elapsed();
+}
+
+void QueryProfiler::setBudget(int budget)
+{
+    if (m_budget == budget) {
+        return;
+    }
+
+    m_budget = budget;
+    for (auto it = m_statistics.begin(); it != m_statistics.end(); ++it) {
+        updateBudget(it.value(), it.key());
+    }
+    emit statisticsChanged();
+}
+
+int QueryProfiler::budget() const
+{
+    return m_budget;
+}
+
+void QueryProfiler::startQuery(Plasma::RunnerManager *manager)
+{
+    // The previous query was replaced before it finished
+    finishQuery(false);
+
+    m_manager = manager;
+    m_query = manager->query();
+    m_queryStart = m_lastInput;
+    m_lastInput = -1;
+    m_queryMatches.clear();
+    m_queryOpen = true;
+}
+
+void QueryProfiler::matchesChanged(Plasma::RunnerManager *manager, const QList<Plasma::QueryMatch> &matches)
+{
+    if (manager->query().isEmpty()) {
+        return;
+    }
+
+    if (manager != m_manager || manager->query() != m_query) {
+        startQuery(manager);
+    }
+
+    const qint64 now = m_clock.elapsed();
+
+    // The matches are all the matches of the query so far
+    QHash<QString, int> counts;
+    for (const Plasma::QueryMatch &match : matches) {
+        if (!match.runner()) {
+            continue;
+        }
+
+        const QString id = match.runner()->id();
+        if (!counts.contains(id) && !m_queryMatches.contains(id) && m_queryStart >= 0) {
+            // First answer of this runner
+            RunnerStatistics &statistics = m_statistics[id];
+            statistics.name = match.runner()->name();
+
+            const int latency = now - m_queryStart;
+            if (statistics.latencies.count() < s_samples) {
+                statistics.latencies.append(latency);
+            } else {
+                statistics.latencies[statistics.nextLatency] = latency;
+                statistics.nextLatency = (statistics.nextLatency + 1) % s_samples;
+            }
+            updateBudget(statistics, id);
+        }
+        ++counts[id];
+    }
+
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        m_queryMatches.insert(it.key(), it.value());
+    }
+
+    emit statisticsChanged();
+}
+
+void QueryProfiler::finishQuery(bool finished)
+{
+    if (!m_queryOpen) {
+        return;
+    }
+    m_queryOpen = false;
+
+    if (!m_manager) {
+        return;
+    }
+
+    const QList<Plasma::AbstractRunner *> runners = m_manager->runners();
+    for (Plasma::AbstractRunner *runner : runners) {
+        RunnerStatistics &statistics = m_statistics[runner->id()];
+        statistics.name = runner->name();
+        ++statistics.queries;
+
+        auto it = m_queryMatches.constFind(runner->id());
+        if (it != m_queryMatches.constEnd()) {
+            statistics.matches += *it;
+        } else if (finished) {
+            ++statistics.queriesWithoutMatches;
+        } else {
+            ++statistics.cancellations;
+        }
+    }
+
+    emit statisticsChanged();
+}
+
+void QueryProfiler::updateBudget(RunnerStatistics &statistics, const QString &id)
+{
+    const bool overBudget = m_budget > 0
+        && statistics.latencies.count() >= s_minimumSamples
+        && statistics.percentile(90) > m_budget;
+
+    if (overBudget && !statistics.overBudget) {
+        qCWarning(KRUNNER) << "Runner" << id << "needs" << statistics.percentile(90)
+                           << "ms to answer 90% of the queries, over the budget of" << m_budget << "ms";
+    }
+    statistics.overBudget = overBudget;
+}
+
+QStringList QueryProfiler::slowestRunners() const
+{
+    // percentile() sorts the samples, compute it once per runner
+    QVector<QPair<int, QString>> runners;
+    runners.reserve(m_statistics.count());
+    for (auto it = m_statistics.constBegin(); it != m_statistics.constEnd(); ++it) {
+        runners.append(qMakePair(it.value().percentile(90), it.key()));
+    }
+    std::sort(runners.begin(), runners.end(), [](const QPair<int, QString> &a, const QPair<int, QString> &b) {
+        return a.first > b.first;
+    });
+
+    QStringList ids;
+    ids.reserve(runners.count());
+    for (const auto &runner : qAsConst(runners)) {
+        ids << runner.second;
+    }
+    return ids;
+}
+
+QString QueryProfiler::report() const
+{
+    QJsonArray runners;
+    const QStringList ids = slowestRunners();
+    for (const QString &id : ids) {
+        const RunnerStatistics statistics = m_statistics.value(id);
+        runners.append(QJsonObject{
+            {QStringLiteral("id"), id},
+            {QStringLiteral("name"), statistics.name},
+            {QStringLiteral("queries"), statistics.queries},
+            {QStringLiteral("matches"), statistics.matches},
+            {QStringLiteral("queriesWithoutMatches"), statistics.queriesWithoutMatches},
+            {QStringLiteral("cancellations"), statistics.cancellations},
+            {QStringLiteral("p50"), statistics.percentile(50)},
+            {QStringLiteral("p90"), statistics.percentile(90)},
+            {QStringLiteral("p99"), statistics.percentile(99)},
+            {QStringLiteral("overBudget"), statistics.overBudget}
+        });
+    }
+
+    const QJsonObject report{
+        {QStringLiteral("budget"), m_budget},
+        {QStringLiteral("runners"), runners}
+    };
+    return QString::fromUtf8(QJsonDocument(report).toJson());
+}
+
+QString QueryProfiler::summary() const
+{
+    QStringList lines;
+    const QStringList ids = slowestRunners();
+    for (const QString &id : ids) {
+        const RunnerStatistics statistics = m_statistics.value(id);
+        if (statistics.latencies.isEmpty()) {
+            continue;
+        }
+        QString line = QStringLiteral("%1: %2 / %3 ms").arg(statistics.name)
+                                                        .arg(statistics.percentile(50))
+                                                        .arg(statistics.percentile(90));
+        if (statistics.overBudget) {
+            line += QStringLiteral(" !");
+        }
+        lines << line;
+        if (lines.count() == 5) {
+            break;
+        }
+    }
+    return lines.join(QLatin1Char('\n'));
+}
@@ -0,0 +1,123 @@
+/*
+ *  Copyright 2026 agent <agent@local>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef QUERYPROFILER_H
+#define QUERYPROFILER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+#include <KRunner/QueryMatch>
+
+namespace Plasma {
+    class RunnerManager;
+}
+
+/**
+ * Measures how long each runner takes to answer what the user types.
+ *
+ * The latency of a runner is the time between the change of the query string
+ * and the first matches of that runner for it, the latest samples are kept to compute
+ * percentiles. Runners whose 90th percentile goes over the configured budget are
+ * reported as slow.
+ */
+class QueryProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QueryProfiler(QObject *parent = nullptr);
+    ~QueryProfiler() override;
+
+    /**
+     * Follows the runner managers found below root, and the queryString property
+     * of the objects which have one: the latencies are measured from its changes.
+     * Managers created later are attached on the next change of the queryString
+     * of an object they belong to
+     */
+    void watch(QObject *root);
+
+    /**
+     * Runners slower than budget milliseconds are reported, 0 disables the budget
+     */
+    void setBudget(int budget);
+    int budget() const;
+
+    /**
+     * The statistics of all runners as JSON
+     */
+    QString report() const;
+
+    /**
+     * A short, human readable summary of the slowest runners: the median
+     * and the 90th percentile of their latency, marked when over budget
+     */
+    QString summary() const;
+
+Q_SIGNALS:
+    void statisticsChanged();
+
+private Q_SLOTS:
+    void queryStringChanged();
+
+private:
+    struct RunnerStatistics {
+        QString name;
+        // Latest latencies in milliseconds, used as a ring buffer
+        QVector<int> latencies;
+        int nextLatency = 0;
+        int queries = 0;
+        int matches = 0;
+        int queriesWithoutMatches = 0;
+        // Queries replaced by a new one before they finished, while this runner hadn't answered
+        int cancellations = 0;
+        bool overBudget = false;
+
+        int percentile(int percent) const;
+    };
+
+    void attach(Plasma::RunnerManager *manager);
+    void startQuery(Plasma::RunnerManager *manager);
+    void matchesChanged(Plasma::RunnerManager *manager, const QList<Plasma::QueryMatch> &matches);
+    void finishQuery(bool finished);
+    void updateBudget(RunnerStatistics &statistics, const QString &id);
+    QStringList slowestRunners() const;
+
+    QSet<Plasma::RunnerManager *> m_managers;
+    // Objects with a queryString whose managers are attached already
+    QSet<QObject *> m_attachedQueryObjects;
+    QHash<QString, RunnerStatistics> m_statistics;
+    int m_budget = 0;
+
+    QElapsedTimer m_clock;
+    qint64 m_lastInput = -1;
+
+    // The query being measured
+    QPointer<Plasma::RunnerManager> m_manager;
+    QString m_query;
+    qint64 m_queryStart = -1;
+    bool m_queryOpen = false;
+    QHash<QString, int> m_queryMatches;
+};
+
+#endif
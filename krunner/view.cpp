@@ -27,6 +27,7 @@
 #include <QQmlEngine>
 #include <QClipboard>
 #include <QPlatformSurfaceEvent>
+#include <QQmlComponent>
 
 #include <KAuthorized>
 #include <KWindowSystem>
@@ -46,11 +47,13 @@
 #include <KWayland/Client/plasmashell.h>
 
 #include "appadaptor.h"
+#include "queryprofiler.h"
 
 View::View(QWindow *)
     : PlasmaQuick::Dialog(),
       m_offset(.5),
-      m_floating(false)
+      m_floating(false),
+      m_profiler(new QueryProfiler(this))
 {
     setClearBeforeRendering(true);
     setColor(QColor(Qt::transparent));
@@ -130,6 +133,49 @@ void View::objectIncubated()
     auto mainItem = qobject_cast<QQuickItem *>(m_qmlObj->rootObject());
     connect(mainItem, &QQuickItem::widthChanged, this, &View::resetScreenPos);
     setMainItem(mainItem);
+
+    // The runner managers belong to the models of the look and feel package
+    m_profiler->watch(m_qmlObj->rootObject());
+    updateStatisticsOverlay();
+}
+
+QString View::queryStatistics() const
+{
+    return m_profiler->report();
+}
+
+void View::updateStatisticsOverlay()
+{
+    auto mainItem = qobject_cast<QQuickItem *>(m_qmlObj->rootObject());
+    if (!mainItem) {
+        return;
+    }
+
+    if (!m_config.readEntry("ShowQueryStatistics", false)) {
+        if (m_statisticsOverlay) {
+            disconnect(m_profiler, &QueryProfiler::statisticsChanged, this, &View::updateStatisticsOverlay);
+            delete m_statisticsOverlay;
+            m_statisticsOverlay = nullptr;
+        }
+        return;
+    }
+
+    if (!m_statisticsOverlay) {
+        QQmlComponent component(m_qmlObj->engine());
+        component.setData("import QtQuick 2.0\n"
+                          "Text { anchors.right: parent.right; anchors.bottom: parent.bottom; "
+                          "horizontalAlignment: Text.AlignRight; font.pointSize: 7; opacity: 0.6; color: \"gray\" }",
+                          QUrl());
+        m_statisticsOverlay = qobject_cast<QQuickItem *>(component.create(m_qmlObj->engine()->rootContext()));
+        if (!m_statisticsOverlay) {
+            return;
+        }
+        m_statisticsOverlay->setParent(mainItem);
+        m_statisticsOverlay->setParentItem(mainItem);
+        connect(m_profiler, &QueryProfiler::statisticsChanged, this, &View::updateStatisticsOverlay);
+    }
+
+    m_statisticsOverlay->setProperty("text", m_profiler->summary());
 }
 
 void View::slotFocusWindowChanged()
@@ -165,6 +211,12 @@ void View::reloadConfig()
     m_config.config()->reparseConfiguration();
     setFreeFloating(m_config.readEntry("FreeFloating", false));
 
+    // Milliseconds a runner may take to answer before it is reported as slow
+    m_profiler->setBudget(m_config.readEntry("RunnerBudget", 250));
+    if (m_qmlObj) {
+        updateStatisticsOverlay();
+    }
+
     const QStringList history = m_config.readEntry("history", QStringList());
     if (m_history != history) {
         m_history = history;
@@ -39,6 +39,8 @@ namespace KWayland {
     }
 }
 
+class QQuickItem;
+class QueryProfiler;
 class ViewPrivate;
 
 class View : public PlasmaQuick::Dialog
@@ -64,6 +66,11 @@ public:
     Q_INVOKABLE void addToHistory(const QString &item);
     Q_INVOKABLE void removeFromHistory(int index);
 
+    /**
+     * Latency statistics of the runners as JSON, see QueryProfiler
+     */
+    QString queryStatistics() const;
+
 Q_SIGNALS:
     void historyChanged();
 
@@ -88,15 +95,18 @@ protected Q_SLOTS:
     void reloadConfig();
     void objectIncubated();
     void slotFocusWindowChanged();
+    void updateStatisticsOverlay();
 
 private:
     void writeHistory();
     QPoint m_customPos;
-    KDeclarative::QmlObject *m_qmlObj;
+    KDeclarative::QmlObject *m_qmlObj = nullptr;
     KConfigGroup m_config;
     qreal m_offset;
     bool m_floating : 1;
     QStringList m_history;
+    QueryProfiler *m_profiler;
+    QQuickItem *m_statisticsOverlay = nullptr;
 };
 
 
@@ -29,6 +29,7 @@
 #include <QDBusReply>
 #include <QDBusVariant>
 #include <QFont>
+#include <QHash>
 #include <QMenu>
 #include <QPointer>
 #include <QTime>
@@ -89,9 +90,14 @@ public:
 
     QSet<int> m_idsRefreshedByAboutToShow;
     QSet<int> m_pendingLayoutUpdates;
+    // Menus whose layout is being fetched
+    QSet<int> m_refreshing;
+    // Revision of the layout we last received, per menu
+    QHash<int, uint> m_layoutRevisions;
 
     QDBusPendingCallWatcher *refresh(int id)
     {
+        m_refreshing << id;
         auto call = m_interface->GetLayout(id, 1, QStringList());
         QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, q);
         watcher->setProperty(DBUSMENU_PROPERTY_ID, id);
@@ -104,9 +110,32 @@ public:
     QMenu *createMenu(QWidget *parent)
     {
         QMenu *menu = q->createMenu(parent);
+        // Hovering a submenu entry is a strong hint it's about to be opened
+        QObject::connect(menu, &QMenu::hovered, q, [this](QAction *action) {
+            prefetch(action);
+        });
         return menu;
     }
 
+    /**
+     * Fetches the layout of the submenu of action if we never did, so that
+     * it can be shown straight away when it's opened
+     */
+    void prefetch(QAction *action)
+    {
+        QMenu *menu = action->menu();
+        if (!menu || !menu->actions().isEmpty()) {
+            return;
+        }
+
+        const int id = action->property(DBUSMENU_PROPERTY_ID).toInt();
+        if (id == 0 || m_refreshing.contains(id) || m_layoutRevisions.contains(id)) {
+            return;
+        }
+
+        refresh(id);
+    }
+
     /**
      * Init all the immutable action properties here
      * TODO: Document immutable properties?
@@ -306,10 +335,14 @@ DBusMenuImporter::~DBusMenuImporter()
 
 void DBusMenuImporter::slotLayoutUpdated(uint revision, int parentId)
 {
-    Q_UNUSED(revision)
     if (d->m_idsRefreshedByAboutToShow.remove(parentId)) {
         return;
     }
+    // We already received a newer layout for this menu
+    const auto it = d->m_layoutRevisions.constFind(parentId);
+    if (it != d->m_layoutRevisions.constEnd() && revision < *it) {
+        return;
+    }
     d->m_pendingLayoutUpdates << parentId;
     if (!d->m_pendingLayoutUpdateTimer->isActive()) {
         d->m_pendingLayoutUpdateTimer->start();
@@ -321,6 +354,11 @@ void DBusMenuImporter::processPendingLayoutUpdates()
     QSet<int> ids = d->m_pendingLayoutUpdates;
     d->m_pendingLayoutUpdates.clear();
     Q_FOREACH(int id, ids) {
+        // Submenus we never fetched get their layout when they are about to be shown,
+        // there's nothing of them to update
+        if (id != 0 && !d->m_layoutRevisions.contains(id) && !d->m_refreshing.contains(id)) {
+            continue;
+        }
         d->refresh(id);
     }
 }
@@ -380,6 +418,8 @@ void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
     int parentId = watcher->property(DBUSMENU_PROPERTY_ID).toInt();
     watcher->deleteLater();
 
+    d->m_refreshing.remove(parentId);
+
     QMenu *menu = d->menuForId(parentId);
 
     QDBusPendingReply<uint, DBusMenuLayoutItem> reply = *watcher;
@@ -401,6 +441,8 @@ void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
         return;
     }
 
+    d->m_layoutRevisions.insert(parentId, reply.argumentAt<0>());
+
     //remove outdated actions
     QSet<int> newDBusMenuItemIds;
     newDBusMenuItemIds.reserve(rootItem.children.count());
@@ -415,10 +457,13 @@ void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
             // When the action is deleted deferred, it is removed from the menu.
             action->deleteLater();
             d->m_actionForId.remove(id);
+            d->m_layoutRevisions.remove(id);
         }
     }
 
     //insert or update new actions into our menu
+    QList<QAction *> layoutActions;
+    layoutActions.reserve(rootItem.children.count());
     for (const DBusMenuLayoutItem &dbusMenuItem: rootItem.children) {
         DBusMenuImporterPrivate::ActionForId::Iterator it = d->m_actionForId.find(dbusMenuItem.id);
         QAction *action = nullptr;
@@ -429,6 +474,7 @@ void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
 
             connect(action, &QObject::destroyed, this, [this, id]() {
                 d->m_actionForId.remove(id);
+                d->m_layoutRevisions.remove(id);
             });
 
             connect(action, &QAction::triggered, this, [ id, this]() {
@@ -439,8 +485,6 @@ void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
                 connect(menuAction, &QMenu::aboutToShow, this, &DBusMenuImporter::slotMenuAboutToShow, Qt::UniqueConnection);
             }
             connect(menu, &QMenu::aboutToHide, this, &DBusMenuImporter::slotMenuAboutToHide, Qt::UniqueConnection);
-
-            menu->addAction(action);
         } else {
             action = *it;
             QStringList filteredKeys = dbusMenuItem.properties.keys();
@@ -448,11 +492,31 @@ void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
             filteredKeys.removeOne("toggle-type");
             filteredKeys.removeOne("children-display");
             d->updateAction(*it, dbusMenuItem.properties, filteredKeys);
-            // Move the action to the tail so we can keep the order same as the dbus request.
-            menu->removeAction(action);
-            menu->addAction(action);
+        }
+        layoutActions << action;
+    }
+
+    // Keep the order same as the dbus request, only touching the actions which are out of place:
+    // every insertion or removal makes the menu lay itself out again
+    const QSet<QAction *> layoutActionSet = layoutActions.toSet();
+    QList<QAction *> menuActions;
+    for (QAction *action : menu->actions()) {
+        if (layoutActionSet.contains(action)) {
+            menuActions << action;
         }
     }
+    for (int i = 0; i < layoutActions.count(); ++i) {
+        QAction *action = layoutActions.at(i);
+        if (i < menuActions.count() && menuActions.at(i) == action) {
+            continue;
+        }
+
+        QAction *before = i < menuActions.count() ? menuActions.at(i) : nullptr;
+        menu->insertAction(before, action);
+
+        menuActions.removeOne(action);
+        menuActions.insert(i, action);
+    }
 
     emit menuUpdated(menu);
 }
@@ -507,8 +571,11 @@ void DBusMenuImporter::slotAboutToShowDBusCallFinished(QDBusPendingCallWatcher *
     bool needRefresh = reply.argumentAt<0>();
 
     if (needRefresh || menu->actions().isEmpty()) {
-        d->m_idsRefreshedByAboutToShow << id;
-        d->refresh(id);
+        // A prefetch of the menu being on its way will announce it as well
+        if (needRefresh || !d->m_refreshing.contains(id)) {
+            d->m_idsRefreshedByAboutToShow << id;
+            d->refresh(id);
+        }
     } else if (menu) {
         menuUpdated(menu);
     }
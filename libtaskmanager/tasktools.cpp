@@ -36,8 +36,10 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <config-X11.h>
 
+#include <QCryptographicHash>
 #include <QDir>
 #include <QGuiApplication>
+#include <QPixmapCache>
 #include <QRegularExpression>
 #include <QScreen>
 #include <QUrlQuery>
@@ -58,9 +60,15 @@ AppData appDataFromUrl(const QUrl &url, const QIcon &fallbackIcon)
 
         if (uQuery.hasQueryItem(QLatin1String("iconData"))) {
             QString iconData(uQuery.queryItemValue(QLatin1String("iconData")));
+            // Launcher urls are resolved over and over, decode their icon once per process
+            const QString key = QLatin1String("taskmanager-icondata-")
+                              + QString::fromLatin1(QCryptographicHash::hash(iconData.toLatin1(), QCryptographicHash::Md5).toHex());
             QPixmap pixmap;
-            QByteArray bytes = QByteArray::fromBase64(iconData.toLocal8Bit(), QByteArray::Base64UrlEncoding);
-            pixmap.loadFromData(bytes);
+            if (!QPixmapCache::find(key, &pixmap)) {
+                QByteArray bytes = QByteArray::fromBase64(iconData.toLocal8Bit(), QByteArray::Base64UrlEncoding);
+                pixmap.loadFromData(bytes);
+                QPixmapCache::insert(key, pixmap);
+            }
             data.icon.addPixmap(pixmap);
         }
 
@@ -0,0 +1,82 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "bookmarkindex.h"
+
+#include <algorithm>
+
+// Queries are a single line, so a term can never match across two fields
+static const QLatin1Char s_separator('\n');
+
+void BookmarkIndex::add(const QString &title, const QString &url, const QString &description)
+{
+    m_records.append({title, url, description});
+    m_offsets.append(m_searchText.size());
+
+    m_searchText += title.toCaseFolded();
+    m_searchText += s_separator;
+    m_searchText += description.toCaseFolded();
+    m_searchText += s_separator;
+    m_searchText += url.toCaseFolded();
+    m_searchText += s_separator;
+}
+
+void BookmarkIndex::clear()
+{
+    m_records.clear();
+    m_offsets.clear();
+    m_searchText.clear();
+}
+
+int BookmarkIndex::count() const
+{
+    return m_records.count();
+}
+
+QList<BookmarkMatch> BookmarkIndex::match(Favicon *favicon, const QString &term, bool addEverything) const
+{
+    QList<BookmarkMatch> results;
+
+    if (addEverything || term.isEmpty()) {
+        for (const Record &record : m_records) {
+            BookmarkMatch bookmarkMatch(favicon, term, record.title, record.url, record.description);
+            bookmarkMatch.addTo(results, addEverything);
+        }
+        return results;
+    }
+
+    const QString foldedTerm = term.toCaseFolded();
+    int from = 0;
+    while ((from = m_searchText.indexOf(foldedTerm, from)) >= 0) {
+        const int record = std::upper_bound(m_offsets.cbegin(), m_offsets.cend(), from) - m_offsets.cbegin() - 1;
+        const Record &found = m_records.at(record);
+
+        // Let BookmarkMatch have the final word, it ignores blank fields
+        BookmarkMatch bookmarkMatch(favicon, term, found.title, found.url, found.description);
+        bookmarkMatch.addTo(results, false);
+
+        // Continue with the next record, a record is added only once
+        if (record + 1 >= m_offsets.count()) {
+            break;
+        }
+        from = m_offsets.at(record + 1);
+    }
+
+    return results;
+}
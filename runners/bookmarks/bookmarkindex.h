@@ -0,0 +1,58 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef BOOKMARKINDEX_H
+#define BOOKMARKINDEX_H
+
+#include <QString>
+#include <QVector>
+#include "bookmarkmatch.h"
+
+class Favicon;
+
+/**
+ * Parsed bookmarks of a browser profile, ready to be matched.
+ *
+ * Besides the records, the index keeps all their searchable fields case folded
+ * in a single string, so a term is found with one scan over it instead of
+ * comparing the fields of every bookmark.
+ */
+class BookmarkIndex
+{
+public:
+    void add(const QString &title, const QString &url, const QString &description = QString());
+    void clear();
+    int count() const;
+
+    QList<BookmarkMatch> match(Favicon *favicon, const QString &term, bool addEverything) const;
+
+private:
+    struct Record {
+        QString title;
+        QString url;
+        QString description;
+    };
+
+    QVector<Record> m_records;
+    // Where the fields of each record start in m_searchText
+    QVector<int> m_offsets;
+    QString m_searchText;
+};
+
+#endif // BOOKMARKINDEX_H
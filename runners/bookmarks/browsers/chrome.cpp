@@ -20,6 +20,7 @@
 
 
 #include "chrome.h"
+#include "bookmarkindex.h"
 #include "faviconfromblob.h"
 #include "browsers/findprofile.h"
 
@@ -31,30 +32,63 @@
 #include <QDebug>
 #include "bookmarksrunner_defs.h"
 #include <QDir>
+#include <QMutex>
+#include <QSharedPointer>
 
 class ProfileBookmarks {
 public:
     ProfileBookmarks(Profile &profile) : m_profile(profile) {}
-    inline QJsonArray bookmarks() { return m_bookmarks; }
     inline Profile profile() { return m_profile; }
-    void tearDown() { m_profile.favicon()->teardown(); clear(); }
-    void add(const QJsonObject &bookmarkEntry) { m_bookmarks << bookmarkEntry; }
-    void clear() { m_bookmarks = QJsonArray(); }
+
+    // Matching runs in the runner threads, while parsing happens in the main thread
+    // when the file changes: matches work on a snapshot of the index
+    QSharedPointer<const BookmarkIndex> bookmarks() {
+        QMutexLocker locker(&m_mutex);
+        return m_active ? m_bookmarks : QSharedPointer<const BookmarkIndex>();
+    }
+    void setBookmarks(const QSharedPointer<const BookmarkIndex> &bookmarks) {
+        QMutexLocker locker(&m_mutex);
+        m_bookmarks = bookmarks;
+        m_parsed = true;
+    }
+    bool isParsed() {
+        QMutexLocker locker(&m_mutex);
+        return m_parsed;
+    }
+    bool hasBookmarks() {
+        QMutexLocker locker(&m_mutex);
+        return !m_bookmarks.isNull();
+    }
+    bool isActive() {
+        QMutexLocker locker(&m_mutex);
+        return m_active;
+    }
+    void setActive(bool active) {
+        QMutexLocker locker(&m_mutex);
+        m_active = active;
+    }
+    void prepare() { setActive(true); m_profile.favicon()->prepare(); }
+    // The parsed bookmarks are kept for the next session, the file watcher keeps them up to date
+    void tearDown() { m_profile.favicon()->teardown(); setActive(false); }
 private:
     Profile m_profile;
-    QJsonArray m_bookmarks;
+    QMutex m_mutex;
+    QSharedPointer<const BookmarkIndex> m_bookmarks;
+    bool m_parsed = false;
+    bool m_active = false;
 };
 
 Chrome::Chrome( FindProfile* findProfile, QObject* parent )
     : QObject(parent),
-    m_watcher(new KDirWatch(this)),
-    m_dirty(false)
+    m_watcher(new KDirWatch(this))
 {
     foreach(Profile profile, findProfile->find()) {
         m_profileBookmarks << new ProfileBookmarks(profile);
         m_watcher->addFile(profile.path());
     }
-    connect(m_watcher, &KDirWatch::created, [=] { m_dirty = true; });
+    connect(m_watcher, &KDirWatch::created, this, &Chrome::bookmarksFileChanged);
+    connect(m_watcher, &KDirWatch::dirty, this, &Chrome::bookmarksFileChanged);
+    connect(m_watcher, &KDirWatch::deleted, this, &Chrome::bookmarksFileChanged);
 }
 
 Chrome::~Chrome()
@@ -66,74 +100,75 @@ Chrome::~Chrome()
 
 QList<BookmarkMatch> Chrome::match(const QString &term, bool addEveryThing)
 {
-    if (m_dirty) {
-        prepare();
-    }
     QList<BookmarkMatch> results;
     foreach(ProfileBookmarks *profileBookmarks, m_profileBookmarks) {
-        results << match(term, addEveryThing, profileBookmarks);
+        const auto bookmarks = profileBookmarks->bookmarks();
+        if (bookmarks) {
+            results << bookmarks->match(profileBookmarks->profile().favicon(), term, addEveryThing);
+        }
     }
     return results;
 }
 
-QList<BookmarkMatch> Chrome::match(const QString &term, bool addEveryThing, ProfileBookmarks *profileBookmarks)
+void Chrome::prepare()
 {
-    QList<BookmarkMatch> results;
-
-    const auto bookmarks = profileBookmarks->bookmarks();
-    for (const QJsonValue &bookmarkValue : bookmarks) {
-        const QJsonObject bookmark = bookmarkValue.toObject();
-
-        QString url = bookmark.value(QStringLiteral("url")).toString();
-
-        BookmarkMatch bookmarkMatch(profileBookmarks->profile().favicon(), term, bookmark.value(QStringLiteral("name")).toString(), url);
-        bookmarkMatch.addTo(results, addEveryThing);
+    foreach(ProfileBookmarks *profileBookmarks, m_profileBookmarks) {
+        if (!profileBookmarks->isParsed()) {
+            parse(profileBookmarks);
+        }
+        if (!profileBookmarks->isActive() && profileBookmarks->hasBookmarks()) {
+            profileBookmarks->prepare();
+        }
     }
-    return results;
 }
 
-void Chrome::prepare()
+void Chrome::teardown()
 {
-    m_dirty = false;
     foreach(ProfileBookmarks *profileBookmarks, m_profileBookmarks) {
-        Profile profile = profileBookmarks->profile();
-        profileBookmarks->clear();
-        QFile bookmarksFile(profile.path());
-        if (!bookmarksFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            continue;
+        if (profileBookmarks->isActive()) {
+            profileBookmarks->tearDown();
         }
-        QJsonDocument jdoc = QJsonDocument::fromJson(bookmarksFile.readAll());
-        if (jdoc.isNull()) {
-            continue;
-        }
-        const QJsonObject resultMap = jdoc.object();
-        if (!resultMap.contains(QLatin1String("roots"))) {
-            return;
-        }
-        const QJsonObject entries = resultMap.value(QStringLiteral("roots")).toObject();
-        for (const QJsonValue &folder : entries) {
-            parseFolder(folder.toObject(), profileBookmarks);
-        }
-        profile.favicon()->prepare();
     }
 }
 
-void Chrome::teardown()
+void Chrome::bookmarksFileChanged(const QString &path)
 {
     foreach(ProfileBookmarks *profileBookmarks, m_profileBookmarks) {
-        profileBookmarks->tearDown();
+        if (profileBookmarks->profile().path() == path) {
+            parse(profileBookmarks);
+        }
     }
 }
 
-void Chrome::parseFolder(const QJsonObject &entry, ProfileBookmarks *profile)
+void Chrome::parse(ProfileBookmarks *profileBookmarks)
+{
+    QSharedPointer<BookmarkIndex> bookmarks;
+
+    QFile bookmarksFile(profileBookmarks->profile().path());
+    if (bookmarksFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        const QJsonDocument jdoc = QJsonDocument::fromJson(bookmarksFile.readAll());
+        const QJsonObject resultMap = jdoc.object();
+        if (resultMap.contains(QLatin1String("roots"))) {
+            bookmarks.reset(new BookmarkIndex);
+            const QJsonObject entries = resultMap.value(QStringLiteral("roots")).toObject();
+            for (const QJsonValue &folder : entries) {
+                parseFolder(folder.toObject(), bookmarks.data());
+            }
+        }
+    }
+
+    profileBookmarks->setBookmarks(bookmarks);
+}
+
+void Chrome::parseFolder(const QJsonObject &entry, BookmarkIndex *index)
 {
     const QJsonArray children = entry.value(QStringLiteral("children")).toArray();
     for (const QJsonValue &child : children) {
         const QJsonObject entry = child.toObject();
         if(entry.value(QStringLiteral("type")).toString() == QLatin1String("folder"))
-            parseFolder(entry, profile);
+            parseFolder(entry, index);
         else {
-            profile->add(entry);
+            index->add(entry.value(QStringLiteral("name")).toString(), entry.value(QStringLiteral("url")).toString());
         }
     }
 }
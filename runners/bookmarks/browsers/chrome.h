@@ -31,6 +31,7 @@
 
 class QJsonObject;
 
+class BookmarkIndex;
 class ProfileBookmarks;
 class Chrome : public QObject, public Browser
 {
@@ -42,12 +43,13 @@ public:
 public Q_SLOTS:
     void prepare() override;
     void teardown() override;
+private Q_SLOTS:
+    void bookmarksFileChanged(const QString &path);
 private:
-    void parseFolder(const QJsonObject &entry, ProfileBookmarks *profile);
-    virtual QList<BookmarkMatch> match(const QString &term, bool addEveryThing, ProfileBookmarks *profileBookmarks);
+    void parse(ProfileBookmarks *profileBookmarks);
+    void parseFolder(const QJsonObject &entry, BookmarkIndex *index);
     QList<ProfileBookmarks*> m_profileBookmarks;
     KDirWatch* m_watcher = nullptr;
-    bool m_dirty;
 
 };
 
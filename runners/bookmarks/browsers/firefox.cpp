@@ -22,7 +22,9 @@
 #include <KJob>
 #include <QDebug>
 #include "bookmarksrunner_defs.h"
+#include "bookmarks_debug.h"
 #include <QFile>
+#include <QFileInfo>
 #include <QDir>
 #include <KConfigGroup>
 #include <KSharedConfig>
@@ -34,7 +36,6 @@
 Firefox::Firefox(QObject *parent) :
     QObject(parent),
     m_favicon(new FallbackFavicon(this)),
-    m_fetchsqlite(nullptr),
     m_fetchsqlite_fav(nullptr)
 {
   reloadConfiguration();
@@ -62,8 +63,7 @@ void Firefox::prepare()
         m_dbCacheFile_fav = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/bookmarkrunnerfirefoxfavdbfile.sqlite");
     }
     if (!m_dbFile.isEmpty()) {
-        m_fetchsqlite = new FetchSqlite(m_dbFile, m_dbCacheFile);
-        m_fetchsqlite->prepare();
+        loadBookmarks();
     }
     if (!m_dbFile_fav.isEmpty()) {
         m_fetchsqlite_fav = new FetchSqlite(m_dbFile_fav, m_dbCacheFile_fav);
@@ -76,29 +76,32 @@ void Firefox::prepare()
     }
 }
 
-QList< BookmarkMatch > Firefox::match(const QString& term, bool addEverything)
+QDateTime Firefox::placesTimestamp() const
 {
-    QList< BookmarkMatch > matches;
-    if (!m_fetchsqlite) {
-        return matches;
+    QDateTime timestamp = QFileInfo(m_dbFile).lastModified();
+    const QFileInfo wal(m_dbFile + QStringLiteral("-wal"));
+    if (wal.exists()) {
+        timestamp = qMax(timestamp, wal.lastModified());
     }
-    //qDebug() << "Firefox bookmark: match " << term;
+    return timestamp;
+}
+
+void Firefox::loadBookmarks()
+{
+    const QDateTime timestamp = placesTimestamp();
+    if (m_bookmarksTimestamp.isValid() && timestamp == m_bookmarksTimestamp && m_dbFile == m_bookmarksFile) {
+        return;
+    }
+
+    FetchSqlite fetchsqlite(m_dbFile, m_dbCacheFile);
+    fetchsqlite.prepare();
 
-    QString query;
-    if (addEverything) {
-        query = QStringLiteral("SELECT moz_bookmarks.fk, moz_bookmarks.title, moz_places.url " \
+    const QString query = QStringLiteral("SELECT moz_bookmarks.fk, moz_bookmarks.title, moz_places.url " \
                     "FROM moz_bookmarks, moz_places WHERE " \
                     "moz_bookmarks.type = 1 AND moz_bookmarks.fk = moz_places.id");
-    } else {
-        query = QString("SELECT moz_bookmarks.fk, moz_bookmarks.title, moz_places.url " \
-                        "FROM moz_bookmarks, moz_places WHERE " \
-                        "moz_bookmarks.type = 1 AND moz_bookmarks.fk = moz_places.id AND " \
-                        "(moz_bookmarks.title LIKE :term OR moz_places.url LIKE :term)");
-    }
-    const QMap<QString, QVariant> bindVariables {
-        {QStringLiteral(":term"), QStringLiteral("%%%1%%").arg(term)},
-    };
-    QList<QVariantMap> results = m_fetchsqlite->query(query, bindVariables);
+    QList<QVariantMap> results = fetchsqlite.query(query, QMap<QString, QVariant>());
+    fetchsqlite.teardown();
+
     QMultiMap<QString, QString> uniqueResults;
     foreach(QVariantMap result, results) {
         const QString title = result.value(QStringLiteral("title")).toString();
@@ -136,8 +139,23 @@ QList< BookmarkMatch > Firefox::match(const QString& term, bool addEverything)
         }
     }
 
+    m_bookmarks.clear();
+    m_bookmarks.reserve(uniqueResults.count());
     for (auto result = uniqueResults.constKeyValueBegin(); result != uniqueResults.constKeyValueEnd(); ++result) {
-        BookmarkMatch bookmarkMatch(m_favicon, term, (*result).second, (*result).first);
+        m_bookmarks.append({(*result).first, (*result).second});
+    }
+    m_bookmarksTimestamp = timestamp;
+    m_bookmarksFile = m_dbFile;
+    qCDebug(RUNNER_BOOKMARKS) << "Loaded" << m_bookmarks.count() << "Firefox bookmarks";
+}
+
+QList< BookmarkMatch > Firefox::match(const QString& term, bool addEverything)
+{
+    QList< BookmarkMatch > matches;
+    //qDebug() << "Firefox bookmark: match " << term;
+
+    for (const Bookmark &bookmark : qAsConst(m_bookmarks)) {
+        BookmarkMatch bookmarkMatch(m_favicon, term, bookmark.title, bookmark.url);
         bookmarkMatch.addTo(matches, addEverything);
     }
 
@@ -147,11 +165,7 @@ QList< BookmarkMatch > Firefox::match(const QString& term, bool addEverything)
 
 void Firefox::teardown()
 {
-    if(m_fetchsqlite) {
-        m_fetchsqlite->teardown();
-        delete m_fetchsqlite;
-        m_fetchsqlite = nullptr;
-    }
+    // The bookmarks are kept, they are only reloaded when the places database changes
     if(m_fetchsqlite_fav) {
         m_fetchsqlite_fav->teardown();
         delete m_fetchsqlite_fav;
@@ -21,7 +21,9 @@
 #ifndef FIREFOX_H
 #define FIREFOX_H
 
+#include <QDateTime>
 #include <QSqlDatabase>
+#include <QVector>
 #include "browser.h"
 
 class Favicon;
@@ -38,13 +40,23 @@ public Q_SLOTS:
     void prepare() override;
 private:
     virtual void reloadConfiguration();
+    void loadBookmarks();
+    QDateTime placesTimestamp() const;
+
+    struct Bookmark {
+        QString url;
+        QString title;
+    };
     QString m_dbFile;
     QString m_dbFile_fav;
     QString m_dbCacheFile;
     QString m_dbCacheFile_fav;
     Favicon * m_favicon;
-    FetchSqlite *m_fetchsqlite;
     FetchSqlite *m_fetchsqlite_fav;
+    // All bookmarks of the places database, so that matching never has to query it
+    QVector<Bookmark> m_bookmarks;
+    QDateTime m_bookmarksTimestamp;
+    QString m_bookmarksFile;
 };
 
 #endif // FIREFOX_H
@@ -23,6 +23,7 @@
 #include "bookmarksrunner_defs.h"
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include "favicon.h"
 
 
@@ -32,46 +33,22 @@ Opera::Opera(QObject* parent): QObject(parent), m_favicon(new FallbackFavicon(th
 
 QList<BookmarkMatch> Opera::match( const QString& term, bool addEverything )
 {
-    QList<BookmarkMatch> matches;
-
-    QLatin1String nameStart("\tNAME=");
-    QLatin1String urlStart("\tURL=");
-    QLatin1String descriptionStart("\tDESCRIPTION=");
-
-    // search
-    foreach (const QString & entry, m_operaBookmarkEntries) {
-        QStringList entryLines = entry.split(QStringLiteral("\n"));
-        if (!entryLines.first().startsWith(QLatin1String("#URL"))) {
-            continue; // skip folder entries
-        }
-        entryLines.pop_front();
-
-        QString name;
-        QString url;
-        QString description;
-
-        foreach (const QString & line, entryLines) {
-            if (line.startsWith(nameStart)) {
-                name = line.mid( QString(nameStart).length() ).simplified();
-            } else if (line.startsWith(urlStart)) {
-                url = line.mid( QString(urlStart).length() ).simplified();
-            } else if (line.startsWith(descriptionStart)) {
-                description = line.mid(QString(descriptionStart).length())
-                              .simplified();
-            }
-        }
-        
-        BookmarkMatch bookmarkMatch(m_favicon, term, name, url, description);
-        bookmarkMatch.addTo(matches, addEverything);
-    }
-    return matches;
+    return m_bookmarks.match(m_favicon, term, addEverything);
 }
 
 
 void Opera::prepare()
 {
-          // open bookmarks file
+        // open bookmarks file
         QString operaBookmarksFilePath = QDir::homePath() + "/.opera/bookmarks.adr";
+        const QDateTime timestamp = QFileInfo(operaBookmarksFilePath).lastModified();
+        if (m_bookmarksTimestamp.isValid() && timestamp == m_bookmarksTimestamp) {
+            // Unchanged since we parsed it
+            return;
+        }
+        m_bookmarks.clear();
+        m_bookmarksTimestamp = QDateTime();
+
         QFile operaBookmarksFile(operaBookmarksFilePath);
         if (!operaBookmarksFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
             //qDebug() << "Could not open Operas Bookmark File " + operaBookmarksFilePath;
@@ -88,14 +65,44 @@ void Opera::prepare()
 
         // load contents
         QString contents = operaBookmarksFile.readAll();
-        m_operaBookmarkEntries = contents.split(QStringLiteral("\n\n"), QString::SkipEmptyParts);
+        const QStringList entries = contents.split(QStringLiteral("\n\n"), QString::SkipEmptyParts);
 
         // close file
         operaBookmarksFile.close();
+
+        QLatin1String nameStart("\tNAME=");
+        QLatin1String urlStart("\tURL=");
+        QLatin1String descriptionStart("\tDESCRIPTION=");
+
+        foreach (const QString & entry, entries) {
+            QStringList entryLines = entry.split(QStringLiteral("\n"));
+            if (!entryLines.first().startsWith(QLatin1String("#URL"))) {
+                continue; // skip folder entries
+            }
+            entryLines.pop_front();
+
+            QString name;
+            QString url;
+            QString description;
+
+            foreach (const QString & line, entryLines) {
+                if (line.startsWith(nameStart)) {
+                    name = line.mid( QString(nameStart).length() ).simplified();
+                } else if (line.startsWith(urlStart)) {
+                    url = line.mid( QString(urlStart).length() ).simplified();
+                } else if (line.startsWith(descriptionStart)) {
+                    description = line.mid(QString(descriptionStart).length())
+                                  .simplified();
+                }
+            }
+
+            m_bookmarks.add(name, url, description);
+        }
+
+        m_bookmarksTimestamp = timestamp;
 }
 
 void Opera::teardown()
 {
-  m_operaBookmarkEntries.clear();
+    // The parsed bookmarks are kept, prepare() only parses the file again when it changed
 }
-
@@ -24,7 +24,8 @@
 #define OPERA_H
 
 #include "browser.h"
-#include <QStringList>
+#include "bookmarkindex.h"
+#include <QDateTime>
 
 class Favicon;
 
@@ -38,7 +39,9 @@ public Q_SLOTS:
     void prepare() override;
     void teardown() override;
 private:
-    QStringList m_operaBookmarkEntries;
+    BookmarkIndex m_bookmarks;
+    // Modification time of the bookmarks file when it was parsed
+    QDateTime m_bookmarksTimestamp;
     Favicon * const m_favicon;
 };
 
@@ -19,7 +19,9 @@
  */
 
 #include "fetchsqlite.h"
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
 #include <QDebug>
 #include "bookmarks_debug.h"
 #include "bookmarksrunner_defs.h"
@@ -30,21 +32,84 @@
 #include <thread>
 #include <sstream>
 
+// Identifies the database a copy was made from, and the state it was in
+static QByteArray sourceStamp(const QString &originalFilePath)
+{
+    const QFileInfo original(originalFilePath);
+    QByteArray stamp = QFile::encodeName(original.absoluteFilePath()) + '\n'
+        + QByteArray::number(original.size()) + ' '
+        + QByteArray::number(original.lastModified().toMSecsSinceEpoch()) + '\n';
+
+    const QFileInfo originalWal(originalFilePath + QStringLiteral("-wal"));
+    if (originalWal.exists()) {
+        stamp += QByteArray::number(originalWal.size()) + ' '
+            + QByteArray::number(originalWal.lastModified().toMSecsSinceEpoch()) + '\n';
+    }
+    return stamp;
+}
+
+static QString stampFilePath(const QString &copyPath)
+{
+    return copyPath + QStringLiteral(".source");
+}
+
+static bool isCopyOutdated(const QString &originalFilePath, const QString &copyPath)
+{
+    // Compares the original with what it was when copied, not with the copy itself:
+    // the copy has a fixed name and may come from another profile
+    if (!QFile::exists(copyPath)) {
+        return true;
+    }
+
+    QFile stampFile(stampFilePath(copyPath));
+    if (!stampFile.open(QIODevice::ReadOnly)) {
+        return true;
+    }
+    return stampFile.readAll() != sourceStamp(originalFilePath);
+}
+
 FetchSqlite::FetchSqlite(const QString &originalFilePath, const QString &copyTo, QObject *parent) :
     QObject(parent), m_databaseFile(copyTo)
 {
-    QFile originalFile(originalFilePath);
+    // The browser keeps its database locked, so we read from a copy.
+    // The copy is kept around and only refreshed when the original changed,
+    // databases can be large and copying them each time the runner is used is expensive
+    if (!isCopyOutdated(originalFilePath, copyTo)) {
+        qCDebug(RUNNER_BOOKMARKS) << "Reusing the copy of" << originalFilePath;
+        return;
+    }
+
+    QFile(stampFilePath(copyTo)).remove();
     QFile(copyTo).remove();
+    QFile(copyTo + QStringLiteral("-wal")).remove();
+    QFile(copyTo + QStringLiteral("-shm")).remove();
+
+    // Taken before copying: if the original changes meanwhile, it gets copied again next time
+    const QByteArray stamp = sourceStamp(originalFilePath);
+
+    QFile originalFile(originalFilePath);
     bool couldCopy = originalFile.copy(copyTo);
     if(!couldCopy) {
         //qDebug() << "error copying favicon database from " << originalFile.fileName() << " to " << copyTo;
         //qDebug() << originalFile.errorString();
+        return;
+    }
+    // It holds the browsing history too, keep it as private as the profile it comes from
+    QFile::setPermissions(copyTo, QFile::ReadOwner | QFile::WriteOwner);
+
+    QFile originalWal(originalFilePath + QStringLiteral("-wal"));
+    if (originalWal.exists() && originalWal.copy(copyTo + QStringLiteral("-wal"))) {
+        QFile::setPermissions(copyTo + QStringLiteral("-wal"), QFile::ReadOwner | QFile::WriteOwner);
+    }
+
+    QFile stampFile(stampFilePath(copyTo));
+    if (stampFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        stampFile.write(stamp);
     }
 }
 
 FetchSqlite::~FetchSqlite()
 {
-    QFile(m_databaseFile).remove();
 }
 
 void FetchSqlite::prepare()
@@ -96,6 +96,28 @@ void TestChromeBookmarks::itShouldFindOnlyMatches()
     verifyMatch(matches[0], "bookmark in other bookmarks", "https://otherbookmarks.com/", 0.45, QueryMatch::PossibleMatch);
 }
 
+void TestChromeBookmarks::itShouldFindMatchesOnlyOnce()
+{
+    Chrome *chrome = new Chrome(m_findBookmarksInCurrentDirectory.data(), this);
+    chrome->prepare();
+    // Matches both the title and the url of the first bookmark
+    QList<BookmarkMatch> matches = chrome->match("SOME", false);
+    QCOMPARE(matches.size(), 2);
+    verifyMatch(matches[0], "some bookmark in bookmark bar", "http://somehost.com/", 0.45, QueryMatch::PossibleMatch);
+    verifyMatch(matches[1], "bookmark in somefolder", "http://somefolder.com/", 0.45, QueryMatch::PossibleMatch);
+}
+
+void TestChromeBookmarks::itShouldFindMatchesAgainAfterTeardown()
+{
+    Chrome *chrome = new Chrome(m_findBookmarksInCurrentDirectory.data(), this);
+    chrome->prepare();
+    chrome->teardown();
+    chrome->prepare();
+    QList<BookmarkMatch> matches = chrome->match("other", false);
+    QCOMPARE(matches.size(), 1);
+    verifyMatch(matches[0], "bookmark in other bookmarks", "http://otherbookmarks.com/", 0.45, QueryMatch::PossibleMatch);
+}
+
 void TestChromeBookmarks::itShouldClearResultAfterCallingTeardown()
 {
     Chrome *chrome = new Chrome(m_findBookmarksInCurrentDirectory.data(), this);
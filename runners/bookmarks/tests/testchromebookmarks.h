@@ -46,6 +46,8 @@ private Q_SLOTS:
   void itShouldGracefullyExitWhenFileIsNotFound();
   void itShouldFindAllBookmarks();
   void itShouldFindOnlyMatches();
+  void itShouldFindMatchesOnlyOnce();
+  void itShouldFindMatchesAgainAfterTeardown();
   void itShouldClearResultAfterCallingTeardown();
   void itShouldFindBookmarksFromAllProfiles();
 
@@ -0,0 +1,60 @@
+/*
+ *   Copyright (C) 2026 agent <agent@local>
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) version 3, or any
+ *   later version accepted by the membership of KDE e.V. (or its
+ *   successor approved by the membership of KDE e.V.), which shall
+ *   act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ *   This library is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QTest>
+
+#include "../calculatorrunner.h"
+
+class CalculatorRunnerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testLeadingZero();
+
+private:
+    QString calculate(const QString &query);
+};
+
+QString CalculatorRunnerTest::calculate(const QString &query)
+{
+    CalculatorRunner runner(this, QVariantList());
+    Plasma::RunnerContext context;
+    context.setQuery(query);
+
+    runner.match(context);
+
+    const auto matches = context.matches();
+    if (matches.count() != 1) {
+        return QString();
+    }
+    return matches.first().text();
+}
+
+void CalculatorRunnerTest::testLeadingZero()
+{
+    // Numbers with leading zeros are decimals, not errors or octals
+    QCOMPARE(calculate(QStringLiteral("09+1")), QStringLiteral("10"));
+    QCOMPARE(calculate(QStringLiteral("010*2")), QStringLiteral("20"));
+}
+
+QTEST_MAIN(CalculatorRunnerTest)
+
+#include "calculatorrunnertest.moc"
@@ -25,22 +25,46 @@
 #include "qalculate_engine.h"
 #else
 #include <QJSEngine>
-#include <QGuiApplication>
-#include <QClipboard>
+#include <QThreadStorage>
 #endif
 
+#include <QClipboard>
+#include <QGuiApplication>
 #include <QIcon>
 #include <QDebug>
+#include <QMutexLocker>
+#include <QRegularExpression>
 
 #include <KLocalizedString>
 #include <krunner/querymatch.h>
 
 static const QString s_copyToClipboardId = QStringLiteral("copyToClipboard");
 
+// Amount of results kept in the cache
+static const int s_cachedResults = 100;
+
+#ifndef ENABLE_QALCULATE
+// Compiled once, matching with a const QRegularExpression is thread safe
+static const QRegularExpression s_andExpression(QStringLiteral("(\\d+)and(\\d+)"));
+static const QRegularExpression s_orExpression(QStringLiteral("(\\d+)or(\\d+)"));
+static const QRegularExpression s_xorExpression(QStringLiteral("(\\d+)xor(\\d+)"));
+static const QRegularExpression s_functionExpression(QStringLiteral("([a-zA-Z]+)"));
+// Leading zeros of numbers, which ECMAScript rejects or reads as octal
+static const QRegularExpression s_leadingZerosExpression(QStringLiteral("(?<![\\d.])0+(?=\\d)"));
+
+// Every runner thread evaluates with its own engine, creating one is expensive
+static QThreadStorage<QJSEngine *> s_engines;
+#endif
+
+// Expressions whose value changes over time can't be cached
+static const QRegularExpression s_volatileExpression(QStringLiteral("rand|now|today|yesterday|tomorrow|time|date"),
+                                                     QRegularExpression::CaseInsensitiveOption);
+
 K_EXPORT_PLASMA_RUNNER(calculatorrunner, CalculatorRunner)
 
 CalculatorRunner::CalculatorRunner( QObject* parent, const QVariantList &args )
     : Plasma::AbstractRunner(parent, args)
+    , m_results(s_cachedResults)
 {
     Q_UNUSED(args)
 
@@ -195,15 +219,9 @@ void CalculatorRunner::userFriendlySubstitutions(QString& cmd)
     hexSubstitutions(cmd);
     powSubstitutions(cmd);
 
-    if (cmd.contains(QRegExp(QStringLiteral("\\d+and\\d+")))) {
-         cmd.replace(QRegExp(QStringLiteral("(\\d+)and(\\d+)")), QStringLiteral("\\1&\\2"));
-    }
-    if (cmd.contains(QRegExp(QStringLiteral("\\d+or\\d+")))) {
-         cmd.replace(QRegExp(QStringLiteral("(\\d+)or(\\d+)")), QStringLiteral("\\1|\\2"));
-    }
-    if (cmd.contains(QRegExp(QStringLiteral("\\d+xor\\d+")))) {
-         cmd.replace(QRegExp(QStringLiteral("(\\d+)xor(\\d+)")), QStringLiteral("\\1^\\2"));
-    }
+    cmd.replace(s_andExpression, QStringLiteral("\\1&\\2"));
+    cmd.replace(s_orExpression, QStringLiteral("\\1|\\2"));
+    cmd.replace(s_xorExpression, QStringLiteral("\\1^\\2"));
     #endif
 }
 
@@ -261,11 +279,29 @@ void CalculatorRunner::match(Plasma::RunnerContext &context)
 
     userFriendlySubstitutions(cmd);
     #ifndef ENABLE_QALCULATE
-    cmd.replace(QRegExp(QStringLiteral("([a-zA-Z]+)")), QStringLiteral("Math.\\1")); //needed for accessing math funktions like sin(),....
+    cmd.replace(s_functionExpression, QStringLiteral("Math.\\1")); //needed for accessing math funktions like sin(),....
     #endif
 
     bool isApproximate = false;
-    QString result = calculate(cmd, &isApproximate);
+    QString result;
+    const bool cacheable = !cmd.contains(s_volatileExpression);
+    bool cached = false;
+    if (cacheable) {
+        QMutexLocker locker(&m_resultsMutex);
+        if (const CachedResult *cachedResult = m_results.object(cmd)) {
+            result = cachedResult->result;
+            isApproximate = cachedResult->isApproximate;
+            cached = true;
+        }
+    }
+    if (!cached) {
+        result = calculate(cmd, &isApproximate);
+        if (cacheable) {
+            QMutexLocker locker(&m_resultsMutex);
+            m_results.insert(cmd, new CachedResult{result, isApproximate});
+        }
+    }
+
     if (!result.isEmpty() && result != cmd) {
         if (toHex) {
             result = QLatin1String("0x") + QString::number(result.toInt(), 16).toUpper();
@@ -290,6 +326,7 @@ QString CalculatorRunner::calculate(const QString& term, bool *isApproximate)
     QString result;
 
     try {
+        QMutexLocker locker(&m_engineMutex);
         result = m_engine->evaluate(term, isApproximate);
     } catch(std::exception& e) {
         qDebug() << "qalculate error: " << e.what();
@@ -299,8 +336,20 @@ QString CalculatorRunner::calculate(const QString& term, bool *isApproximate)
     #else
     Q_UNUSED(isApproximate);
     //qDebug() << "calculating" << term;
-    QJSEngine eng;
-    QJSValue result = eng.evaluate(QStringLiteral("var result = %1; result").arg(term));
+    if (!s_engines.hasLocalData()) {
+        QJSEngine *engine = new QJSEngine;
+        // Every name in an expression is turned into a member of Math,
+        // don't let one expression change it for the next ones
+        engine->evaluate(QStringLiteral("Object.freeze(Math)"));
+        s_engines.setLocalData(engine);
+    }
+    QJSEngine &eng = *s_engines.localData();
+    // People type numbers like "09" as decimals
+    QString expression = term;
+    expression.remove(s_leadingZerosExpression);
+    // The engine is shared by all the expressions of the thread: evaluate each one
+    // in its own scope. Not a strict one, which would reject all legacy number forms
+    QJSValue result = eng.evaluate(QStringLiteral("(function() { return (%1); })()").arg(expression));
 
     if (result.isError()) {
         return QString();
@@ -317,9 +366,11 @@ QString CalculatorRunner::calculate(const QString& term, bool *isApproximate)
 
     //ECMAScript has issues with the last digit in simple rational computations
     //This script rounds off the last digit; see bug 167986
-    QString roundedResultString = eng.evaluate(QStringLiteral("var exponent = 14-(1+Math.floor(Math.log(Math.abs(result))/Math.log(10)));\
+    QJSValue round = eng.evaluate(QStringLiteral("(function(result) { \"use strict\";\
+                                                var exponent = 14-(1+Math.floor(Math.log(Math.abs(result))/Math.log(10)));\
                                                 var order=Math.pow(10,exponent);\
-                                                (order > 0? Math.round(result*order)/order : 0)")).toString();
+                                                return (order > 0? Math.round(result*order)/order : 0); })"));
+    QString roundedResultString = round.call(QJSValueList() << result).toString();
 
     roundedResultString.replace(QLatin1Char('.'), QLocale().decimalPoint(), Qt::CaseInsensitive);
 
@@ -331,11 +382,8 @@ void CalculatorRunner::run(const Plasma::RunnerContext &context, const Plasma::Q
 {
     Q_UNUSED(context);
     if (match.selectedAction() == action(s_copyToClipboardId)) {
-#ifdef ENABLE_QALCULATE
-        m_engine->copyToClipboard();
-#else
+        // Not the last result of the engine: the match may come from the cache
         QGuiApplication::clipboard()->setText(match.text());
-#endif
     }
 }
 
@@ -20,7 +20,9 @@
 #ifndef CALCULATORRUNNER_H
 #define CALCULATORRUNNER_H
 
+#include <QCache>
 #include <QMimeData>
+#include <QMutex>
 
 #ifdef ENABLE_QALCULATE
 class QalculateEngine;
@@ -54,7 +56,18 @@ class CalculatorRunner : public Plasma::AbstractRunner
 
         #ifdef ENABLE_QALCULATE
         QalculateEngine* m_engine;
+        // libqalculate has a single, global calculator which is not thread safe
+        QMutex m_engineMutex;
         #endif
+
+        struct CachedResult {
+            QString result;
+            bool isApproximate;
+        };
+        // Results of the latest expressions, after substitutions, so that
+        // retyping or erasing part of an expression doesn't evaluate it again
+        QCache<QString, CachedResult> m_results; // protected by m_resultsMutex
+        QMutex m_resultsMutex;
 };
 
 #endif
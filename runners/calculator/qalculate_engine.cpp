@@ -27,8 +27,6 @@
 #include <libqalculate/Function.h>
 
 #include <QFile>
-#include <QApplication>
-#include <QClipboard>
 #include <QDebug>
 
 #include <KLocalizedString>
@@ -125,10 +123,3 @@ QString QalculateEngine::evaluate(const QString& expression, bool *isApproximate
     return m_lastResult;
 }
 
-void QalculateEngine::copyToClipboard(bool flag)
-{
-    Q_UNUSED(flag);
-
-    QApplication::clipboard()->setText(m_lastResult);
-}
-
@@ -38,8 +38,6 @@ public Q_SLOTS:
     QString evaluate(const QString& expression, bool *isApproximate = nullptr);
 	void updateExchangeRates();
 
-	void copyToClipboard(bool flag = true);
-
 protected Q_SLOTS:
         void updateResult(KJob*);
 
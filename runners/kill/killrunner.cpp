@@ -24,30 +24,22 @@
 #include <QIcon>
 
 #include <KProcess>
-#include <KUser>
 #include <kauth.h>
 
-#include "processcore/processes.h"
-#include "processcore/process.h"
-
 #include "killrunner_config.h"
+#include "processtable.h"
 
 K_EXPORT_PLASMA_RUNNER(kill, KillRunner)
 
 KillRunner::KillRunner(QObject *parent, const QVariantList& args)
         : Plasma::AbstractRunner(parent, args),
-          m_processes(nullptr)
+          m_processTable(new ProcessTable(this))
 {
     Q_UNUSED(args);
     setObjectName( QLatin1String("Kill Runner") );
     reloadConfiguration();
 
-    connect(this, &Plasma::AbstractRunner::prepare, this, &KillRunner::prep);
     connect(this, &Plasma::AbstractRunner::teardown, this, &KillRunner::cleanup);
-
-    m_delayedCleanupTimer.setInterval(50);
-    m_delayedCleanupTimer.setSingleShot(true);
-    connect(&m_delayedCleanupTimer, &QTimer::timeout, this, &KillRunner::cleanup);
 }
 
 KillRunner::~KillRunner()
@@ -70,25 +62,10 @@ void KillRunner::reloadConfiguration()
     setSyntaxes(syntaxes);
 }
 
-void KillRunner::prep()
-{
-    m_delayedCleanupTimer.stop();
-}
-
 void KillRunner::cleanup()
 {
-    if (!m_processes) {
-        return;
-    }
-
-    if (m_prepLock.tryLockForWrite()) {
-        delete m_processes;
-        m_processes = nullptr;
-
-        m_prepLock.unlock();
-    } else {
-        m_delayedCleanupTimer.stop();
-    }
+    // Matches still running keep their copy of the table
+    m_processTable->stop();
 }
 
 void KillRunner::match(Plasma::RunnerContext &context)
@@ -99,41 +76,32 @@ void KillRunner::match(Plasma::RunnerContext &context)
         return;
     }
 
-    m_prepLock.lockForRead();
-    if (!m_processes) {
-        m_prepLock.unlock();
-        m_prepLock.lockForWrite();
-        if (!m_processes) {
-            suspendMatching(true);
-            m_processes = new KSysGuard::Processes();
-            m_processes->updateAllProcesses();
-            suspendMatching(false);
-        }
-    }
-    m_prepLock.unlock();
-
     term = term.right(term.length() - m_triggerWord.length());
 
     if (term.length() < 2)  {
         return;
     }
 
+    const auto processes = m_processTable->processes();
+    if (!processes) {
+        return;
+    }
+
+    const QString foldedTerm = term.toCaseFolded();
     QList<Plasma::QueryMatch> matches;
-    const QList<KSysGuard::Process *> processlist = m_processes->getAllProcesses();
-    foreach (const KSysGuard::Process *process, processlist) {
+    for (const ProcessTable::Process &process : *processes) {
         if (!context.isValid()) {
             return;
         }
 
-        const QString name = process->name();
-        if (!name.contains(term, Qt::CaseInsensitive)) {
+        if (!process.foldedName.contains(foldedTerm)) {
             //Process doesn't match the search term
             continue;
         }
 
-        const quint64 pid = process->pid();
-        const qlonglong uid = process->uid();
-        const QString user = getUserName(uid);
+        const QString &name = process.name;
+        const quint64 pid = process.pid;
+        const QString &user = process.user;
 
         QVariantList data;
         data << pid << user;
@@ -148,10 +116,10 @@ void KillRunner::match(Plasma::RunnerContext &context)
         // Set the relevance
         switch (m_sorting) {
         case KillRunnerConfig::CPU:
-            match.setRelevance((process->userUsage() + process->sysUsage()) / 100);
+            match.setRelevance(process.cpuUsage);
             break;
         case KillRunnerConfig::CPUI:
-            match.setRelevance(1 - (process->userUsage() + process->sysUsage()) / 100);
+            match.setRelevance(1 - process.cpuUsage);
             break;
         case KillRunnerConfig::NONE:
             match.setRelevance(name.compare(term, Qt::CaseInsensitive) == 0 ? 1 : 9);
@@ -212,14 +180,4 @@ QList<QAction*> KillRunner::actionsForMatch(const Plasma::QueryMatch &match)
     return ret;
 }
 
-QString KillRunner::getUserName(qlonglong uid)
-{
-    KUser user(uid);
-    if (user.isValid()) {
-        return user.loginName();
-    }
-    qDebug() << QStringLiteral("No user with UID %1 was found").arg(uid);
-    return QStringLiteral("root");//No user with UID uid was found, so root is used
-}
-
 #include "killrunner.moc"
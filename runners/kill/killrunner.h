@@ -20,19 +20,11 @@
 #ifndef KILLRUNNER_H
 #define KILLRUNNER_H
 
-#include <QReadWriteLock>
-#include <QTimer>
-
 #include <KRunner/AbstractRunner>
 
 #include "killrunner_config.h"
 class QAction;
-
-namespace KSysGuard
-{
-    class Processes;
-    class Process;
-}
+class ProcessTable;
 
 class KillRunner : public Plasma::AbstractRunner
 {
@@ -48,29 +40,17 @@ public:
     void reloadConfiguration() override;
 
 private Q_SLOTS:
-    void prep();
     void cleanup();
 
 private:
-    /** @param uid the uid of the user
-      * @return the username of the user with the UID uid
-      */
-    QString getUserName(qlonglong uid);
-
     /** The trigger word */
     QString m_triggerWord;
 
     /** How to sort */
     KillRunnerConfig::Sort m_sorting;
 
-    /** process lister */
-    KSysGuard::Processes *m_processes;
-
-    /** lock for initializing m_processes */
-    QReadWriteLock m_prepLock;
-
-    /** timer for retrying the cleanup due to lock contention */
-    QTimer m_delayedCleanupTimer;
+    /** process lister, reads the processes on the first match of a session */
+    ProcessTable *m_processTable;
 };
 
 #endif
@@ -0,0 +1,291 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "processtable.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+#include <KUser>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#else
+#include "processcore/processes.h"
+#include "processcore/process.h"
+#endif
+
+// How often the table is read again while the runner is in use
+static const int s_refreshInterval = 2000;
+
+struct ProcessSample {
+    quint64 pid = 0;
+    qlonglong uid = 0;
+    quint64 ticks = 0;
+    QString name;
+};
+
+static QVector<ProcessSample> readProcesses();
+
+ProcessTable::ProcessTable(QObject *parent)
+    : QObject(parent)
+    , m_refreshTimer(new QTimer(this))
+{
+    m_refreshTimer->setInterval(s_refreshInterval);
+    connect(m_refreshTimer, &QTimer::timeout, this, &ProcessTable::refresh);
+}
+
+ProcessTable::~ProcessTable()
+{
+    QFuture<void> scan;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_running = false;
+        scan = m_scan;
+    }
+    scan.waitForFinished();
+}
+
+QSharedPointer<const ProcessTable::Processes> ProcessTable::processes()
+{
+    QFuture<void> scan;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_processes) {
+            return m_processes;
+        }
+
+        if (!m_running) {
+            m_running = true;
+            if (!m_scan.isRunning()) {
+                m_scan = QtConcurrent::run(this, &ProcessTable::scan);
+            }
+            // The timer lives in the main thread
+            QMetaObject::invokeMethod(this, "startRefreshing", Qt::QueuedConnection);
+        }
+        scan = m_scan;
+    }
+
+    // A scan which was already going on publishes its result too, now that we are running
+    scan.waitForFinished();
+
+    QMutexLocker locker(&m_mutex);
+    return m_processes;
+}
+
+void ProcessTable::stop()
+{
+    m_refreshTimer->stop();
+
+    QMutexLocker locker(&m_mutex);
+    m_running = false;
+    m_processes.reset();
+}
+
+void ProcessTable::startRefreshing()
+{
+    // stop() may have been called before this queued call got delivered
+    QMutexLocker locker(&m_mutex);
+    if (m_running) {
+        m_refreshTimer->start();
+    }
+}
+
+void ProcessTable::refresh()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_running && !m_scan.isRunning()) {
+        m_scan = QtConcurrent::run(this, &ProcessTable::scan);
+    }
+}
+
+void ProcessTable::scan()
+{
+    const QVector<ProcessSample> samples = readProcesses();
+
+    // Ticks all the CPUs had since the previous scan
+    qreal elapsedTicks = 0;
+#ifdef Q_OS_LINUX
+    if (m_sinceLastScan.isValid()) {
+        elapsedTicks = m_sinceLastScan.elapsed() / 1000.0 * sysconf(_SC_CLK_TCK) * QThread::idealThreadCount();
+    }
+#endif
+    m_sinceLastScan.start();
+
+    QSharedPointer<Processes> processes(new Processes);
+    processes->reserve(samples.count());
+    QHash<quint64, quint64> ticks;
+    ticks.reserve(samples.count());
+
+    for (const ProcessSample &sample : samples) {
+        Process process;
+        process.pid = sample.pid;
+        process.name = sample.name;
+        process.foldedName = sample.name.toCaseFolded();
+        process.user = userName(sample.uid);
+
+        auto previous = m_previousTicks.constFind(sample.pid);
+        if (elapsedTicks > 0 && previous != m_previousTicks.constEnd() && *previous <= sample.ticks) {
+            process.cpuUsage = qMin<qreal>(1, (sample.ticks - *previous) / elapsedTicks);
+        }
+        ticks.insert(sample.pid, sample.ticks);
+
+        processes->append(process);
+    }
+    m_previousTicks = ticks;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_running) {
+        m_processes = processes;
+    }
+}
+
+#ifdef Q_OS_LINUX
+static ProcessSample readProcess(const quint64 &pid)
+{
+    ProcessSample sample;
+    const QByteArray directory = "/proc/" + QByteArray::number(pid);
+
+    // The owner of the directory is root for processes which aren't dumpable,
+    // the real uid is the first one of the Uid line
+    QFile statusFile(QString::fromLatin1(directory + "/status"));
+    if (!statusFile.open(QIODevice::ReadOnly)) {
+        return sample;
+    }
+    qlonglong uid = -1;
+    while (!statusFile.atEnd()) {
+        const QByteArray line = statusFile.readLine();
+        if (line.startsWith("Uid:")) {
+            uid = line.mid(4).simplified().split(' ').value(0).toLongLong();
+            break;
+        }
+    }
+    if (uid < 0) {
+        return sample;
+    }
+
+    QFile statFile(QString::fromLatin1(directory + "/stat"));
+    if (!statFile.open(QIODevice::ReadOnly)) {
+        return sample;
+    }
+    const QByteArray stat = statFile.readAll();
+
+    // pid (comm) state ppid ..., comm can contain spaces and parentheses
+    const int nameStart = stat.indexOf('(');
+    const int nameEnd = stat.lastIndexOf(')');
+    if (nameStart < 0 || nameEnd < nameStart) {
+        return sample;
+    }
+
+    // utime and stime are the 14th and 15th fields, the state, the 3rd one, comes after the name
+    const QList<QByteArray> fields = stat.mid(nameEnd + 2).split(' ');
+    if (fields.count() < 13) {
+        return sample;
+    }
+
+    sample.pid = pid;
+    sample.uid = uid;
+    sample.ticks = fields.at(11).toULongLong() + fields.at(12).toULongLong();
+    QByteArray name = stat.mid(nameStart + 1, nameEnd - nameStart - 1);
+
+    // The kernel truncates the name to 15 characters, take the full one from the
+    // command line then, if it starts the same, as KSysGuard does
+    if (name.length() == 15) {
+        QFile cmdlineFile(QString::fromLatin1(directory + "/cmdline"));
+        if (cmdlineFile.open(QIODevice::ReadOnly)) {
+            QByteArray command = cmdlineFile.readAll();
+            const int argumentsStart = command.indexOf('\0');
+            if (argumentsStart >= 0) {
+                command.truncate(argumentsStart);
+            }
+            command = command.mid(command.lastIndexOf('/') + 1);
+            if (command.startsWith(name)) {
+                name = command;
+            }
+        }
+    }
+
+    sample.name = QString::fromLocal8Bit(name);
+    return sample;
+}
+#endif
+
+static QVector<ProcessSample> readProcesses()
+{
+    QVector<ProcessSample> samples;
+
+#ifdef Q_OS_LINUX
+    const QStringList entries = QDir(QStringLiteral("/proc")).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QVector<quint64> pids;
+    pids.reserve(entries.count());
+    for (const QString &entry : entries) {
+        bool ok;
+        const quint64 pid = entry.toULongLong(&ok);
+        if (ok) {
+            pids << pid;
+        }
+    }
+
+    samples = QtConcurrent::blockingMapped<QVector<ProcessSample>>(pids, readProcess);
+
+    // Processes which went away while reading
+    samples.erase(std::remove_if(samples.begin(), samples.end(), [](const ProcessSample &sample) {
+        return sample.pid == 0;
+    }), samples.end());
+#else
+    KSysGuard::Processes processes;
+    processes.updateAllProcesses();
+    const QList<KSysGuard::Process *> processList = processes.getAllProcesses();
+    for (const KSysGuard::Process *process : processList) {
+        ProcessSample sample;
+        sample.pid = process->pid();
+        sample.uid = process->uid();
+        sample.name = process->name();
+        samples << sample;
+    }
+#endif
+
+    return samples;
+}
+
+QString ProcessTable::userName(qlonglong uid)
+{
+    auto it = m_userNames.constFind(uid);
+    if (it != m_userNames.constEnd()) {
+        return *it;
+    }
+
+    QString name;
+    KUser user(uid);
+    if (user.isValid()) {
+        name = user.loginName();
+    } else {
+        qDebug() << QStringLiteral("No user with UID %1 was found").arg(uid);
+        name = QStringLiteral("root");//No user with UID uid was found, so root is used
+    }
+
+    m_userNames.insert(uid, name);
+    return name;
+}
@@ -0,0 +1,87 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROCESSTABLE_H
+#define PROCESSTABLE_H
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * The processes the kill runner offers to terminate.
+ *
+ * Only what the runner shows is read from /proc, spread over the thread pool,
+ * and the table is refreshed in the background while it is in use,
+ * so the CPU usage reflects the time between two refreshes.
+ */
+class ProcessTable : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Process {
+        quint64 pid = 0;
+        QString name;
+        QString foldedName;
+        QString user;
+        /** share of the total CPU time since the previous refresh, between 0 and 1 */
+        qreal cpuUsage = 0;
+    };
+    typedef QVector<Process> Processes;
+
+    explicit ProcessTable(QObject *parent = nullptr);
+    ~ProcessTable() override;
+
+    /**
+     * Starts reading the processes if that is not done yet, waits for the first
+     * refresh and returns the latest table. Can be called from any thread
+     */
+    QSharedPointer<const Processes> processes();
+
+public Q_SLOTS:
+    /** Stops refreshing and drops the table, called in the main thread */
+    void stop();
+
+private Q_SLOTS:
+    void startRefreshing();
+    void refresh();
+
+private:
+    void scan();
+    QString userName(qlonglong uid);
+
+    QMutex m_mutex;
+    bool m_running = false; // protected by m_mutex
+    QFuture<void> m_scan; // protected by m_mutex
+    QSharedPointer<const Processes> m_processes; // protected by m_mutex
+    QTimer *m_refreshTimer;
+
+    // only used by the scan, scans never overlap
+    QHash<quint64, quint64> m_previousTicks;
+    QHash<qlonglong, QString> m_userNames;
+    QElapsedTimer m_sinceLastScan;
+};
+
+#endif
@@ -21,7 +21,10 @@
 
 #include <QAction>
 #include <QDir>
+#include <QFileInfo>
 #include <QMimeData>
+#include <QMutexLocker>
+#include <QSet>
 
 #include <KDesktopFile>
 #include <KConfigGroup>
@@ -56,15 +59,80 @@ RecentDocuments::~RecentDocuments()
 {
 }
 
+// Called in the main thread
 void RecentDocuments::loadRecentDocuments()
 {
-    m_recentdocuments = KRecentDocument::recentDocuments();
+    QSharedPointer<const RecentDocumentList> previous;
+    {
+        QMutexLocker locker(&m_mutex);
+        previous = m_recentdocuments;
+    }
+
+    // Only parse the files which changed since the last time
+    QHash<QString, const RecentDocument *> parsed;
+    if (previous) {
+        for (const RecentDocument &document : *previous) {
+            parsed.insert(document.desktopFile, &document);
+        }
+    }
+
+    const QString homePath = QDir::homePath();
+    QSharedPointer<RecentDocumentList> documents(new RecentDocumentList);
+    // avoid duplicates
+    QSet<QUrl> knownUrls;
+
+    const QStringList desktopFiles = KRecentDocument::recentDocuments();
+    for (const QString &desktopFile : desktopFiles) {
+        const QDateTime modified = QFileInfo(desktopFile).lastModified();
+
+        RecentDocument document;
+        const RecentDocument *known = parsed.value(desktopFile);
+        if (known && known->modified == modified) {
+            document = *known;
+        } else {
+            KDesktopFile config(desktopFile);
+
+            document.desktopFile = desktopFile;
+            document.modified = modified;
+            document.url = QUrl(config.readUrl());
+            document.name = config.readName();
+            document.iconName = config.readIcon();
+            document.searchText = document.name.toCaseFolded() + QLatin1Char('\n') + document.url.fileName().toCaseFolded();
+
+            QUrl folderUrl = document.url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash);
+            if (folderUrl.isLocalFile()) {
+                QString folderPath = folderUrl.toLocalFile();
+                if (folderPath.startsWith(homePath)) {
+                    folderPath.replace(0, homePath.length(), QStringLiteral("~"));
+                }
+                document.subtext = folderPath;
+            } else {
+                document.subtext = folderUrl.toDisplayString();
+            }
+        }
+
+        if (knownUrls.contains(document.url)) {
+            continue;
+        }
+        knownUrls.insert(document.url);
+
+        documents->append(document);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_recentdocuments = documents;
 }
 
 
 void RecentDocuments::match(Plasma::RunnerContext &context)
 {
-    if (m_recentdocuments.isEmpty()) {
+    QSharedPointer<const RecentDocumentList> documents;
+    {
+        QMutexLocker locker(&m_mutex);
+        documents = m_recentdocuments;
+    }
+
+    if (!documents || documents->isEmpty()) {
         return;
     }
 
@@ -73,43 +141,21 @@ void RecentDocuments::match(Plasma::RunnerContext &context)
         return;
     }
 
-    const QString homePath = QDir::homePath();
-
-    // avoid duplicates
-    QSet<QUrl> knownUrls;
+    const QString foldedTerm = term.toCaseFolded();
 
-    foreach (const QString &document, m_recentdocuments) {
+    for (const RecentDocument &document : *documents) {
         if (!context.isValid()) {
             return;
         }
 
-        if (document.contains(term, Qt::CaseInsensitive)) {
-            KDesktopFile config(document);
-
-            const QUrl url = QUrl(config.readUrl());
-            if (knownUrls.contains(url)) {
-                continue;
-            }
-
-            knownUrls.insert(url);
-
+        if (document.searchText.contains(foldedTerm)) {
             Plasma::QueryMatch match(this);
             match.setType(Plasma::QueryMatch::PossibleMatch);
             match.setRelevance(1.0);
-            match.setIconName(config.readIcon());
-            match.setData(url);
-            match.setText(config.readName());
-
-            QUrl folderUrl = url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash);
-            if (folderUrl.isLocalFile()) {
-                QString folderPath = folderUrl.toLocalFile();
-                if (folderPath.startsWith(homePath)) {
-                    folderPath.replace(0, homePath.length(), QStringLiteral("~"));
-                }
-                match.setSubtext(folderPath);
-            } else {
-                match.setSubtext(folderUrl.toDisplayString());
-            }
+            match.setIconName(document.iconName);
+            match.setData(document.url);
+            match.setText(document.name);
+            match.setSubtext(document.subtext);
 
             context.addMatch(match);
         }
@@ -22,7 +22,13 @@
 
 #include <krunner/abstractrunner.h>
 
+#include <QDateTime>
+#include <QHash>
 #include <QIcon>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QUrl>
+#include <QVector>
 
 class RecentDocuments : public Plasma::AbstractRunner {
     Q_OBJECT
@@ -42,7 +48,21 @@ class RecentDocuments : public Plasma::AbstractRunner {
         void loadRecentDocuments();
 
     private:
-        QStringList m_recentdocuments;
+        struct RecentDocument {
+            QString desktopFile;
+            QDateTime modified;
+            QUrl url;
+            QString name;
+            QString iconName;
+            QString subtext;
+            // What the query is matched against: the name and the file name of the url, case folded
+            QString searchText;
+        };
+        typedef QVector<RecentDocument> RecentDocumentList;
+
+        // Each document once, most recently used first, parsed when the recent documents change
+        QSharedPointer<const RecentDocumentList> m_recentdocuments; // protected by m_mutex
+        QMutex m_mutex;
 };
 
 
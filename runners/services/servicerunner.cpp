@@ -34,6 +34,7 @@
 #include <KService>
 #include <KServiceTypeTrader>
 #include <KStringHandler>
+#include <KSycoca>
 
 #include "debug.h"
 
@@ -43,16 +44,116 @@ int weightedLength(const QString &query) {
     return KStringHandler::logicalLength(query);
 }
 
+bool containsAll(const QString &haystack, const QVector<QString> &needles) {
+    for (const QString &needle : needles) {
+        if (!haystack.contains(needle)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool listContains(const QStringList &list, const QString &needle) {
+    for (const QString &item : list) {
+        if (item.contains(needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool listContainsAll(const QStringList &list, const QVector<QString> &needles) {
+    for (const QString &needle : needles) {
+        if (!listContains(list, needle)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 }  // namespace
 
+/**
+ * @brief A service with its searchable fields case folded once
+ *
+ * Empty fields stand for properties the desktop file does not define,
+ * which is what "exist" tested in the trader queries this replaces.
+ */
+struct IndexedService
+{
+    explicit IndexedService(const KService::Ptr &service)
+        : service(service)
+        , name(service->name().toCaseFolded())
+        , genericName(service->genericName().toCaseFolded())
+        , exec(service->exec().toCaseFolded())
+        , comment(service->comment().toCaseFolded())
+    {
+        for (const QString &keyword : service->keywords()) {
+            keywords << keyword.toCaseFolded();
+        }
+        for (const QString &category : service->categories()) {
+            categories << category.toCaseFolded();
+        }
+    }
+
+    KService::Ptr service;
+    QString name;
+    QString genericName;
+    QString exec;
+    QString comment;
+    QStringList keywords;
+    QStringList categories;
+};
+
+/**
+ * @brief Snapshot of the services the runner matches against
+ *
+ * Holds the same services, in the same order, as the unconstrained trader queries,
+ * so filtering them in memory gives the same results as the constrained queries did,
+ * without building and evaluating a trader query for each step of each keystroke.
+ */
+class ServiceIndex
+{
+public:
+    ServiceIndex()
+    {
+        const KService::List applications = KServiceTypeTrader::self()->query(QStringLiteral("Application"));
+        m_applications.reserve(applications.count());
+        for (const KService::Ptr &service : applications) {
+            m_applications << IndexedService(service);
+        }
+
+        const KService::List kcms = KServiceTypeTrader::self()->query(QStringLiteral("KCModule"));
+        m_kcms.reserve(kcms.count());
+        for (const KService::Ptr &service : kcms) {
+            m_kcms << IndexedService(service);
+        }
+    }
+
+    const QVector<IndexedService> &applications() const
+    {
+        return m_applications;
+    }
+
+    const QVector<IndexedService> &kcms() const
+    {
+        return m_kcms;
+    }
+
+private:
+    QVector<IndexedService> m_applications;
+    QVector<IndexedService> m_kcms;
+};
+
 /**
  * @brief Finds all KServices for a given runner query
  */
 class ServiceFinder
 {
 public:
-    ServiceFinder(ServiceRunner *runner)
+    ServiceFinder(ServiceRunner *runner, const QSharedPointer<const ServiceIndex> &index)
          : m_runner(runner)
+         , m_index(index)
     {}
 
 
@@ -63,6 +164,7 @@ public:
         }
 
         term = context.query();
+        foldedTerm = term.toCaseFolded();
         weightedTermLength = weightedLength(term);
 
         matchExectuables();
@@ -134,32 +236,23 @@ private:
         return relevanceIncrement;
     }
 
-    QString generateQuery(QVector<QStringRef> &strList)
+    // Applications which are executable and each word of the term case-insensitively matches
+    // * a substring of one of the keywords
+    // * a substring of the GenericName field
+    // * a substring of the Name field
+    // * a substring of the Comment field
+    // or whose Exec contains the first word
+    bool matchesWords(const IndexedService &indexed, const QVector<QString> &words, const QString &firstWord) const
     {
-        QString keywordTemplate = QStringLiteral("exist Keywords");
-        QString genericNameTemplate = QStringLiteral("exist GenericName");
-        QString nameTemplate = QStringLiteral("exist Name");
-        QString commentTemplate = QStringLiteral("exist Comment");
-
-        // Search for applications which are executable and the term case-insensitive matches any of
-        // * a substring of one of the keywords
-        // * a substring of the GenericName field
-        // * a substring of the Name field
-        // Note that before asking for the content of e.g. Keywords and GenericName we need to ask if
-        // they exist to prevent a tree evaluation error if they are not defined.
-        foreach (QStringRef str, strList)
-        {
-            keywordTemplate += QStringLiteral(" and '%1' ~subin Keywords").arg(str.toString());
-            genericNameTemplate += QStringLiteral(" and '%1' ~~ GenericName").arg(str.toString());
-            nameTemplate += QStringLiteral(" and '%1' ~~ Name").arg(str.toString());
-            commentTemplate += QStringLiteral(" and '%1' ~~ Comment").arg(str.toString());
+        if (indexed.exec.isEmpty()) {
+            return false;
         }
 
-        QString finalQuery = QStringLiteral("exist Exec and ( (%1) or (%2) or (%3) or ('%4' ~~ Exec) or (%5) )")
-            .arg(keywordTemplate, genericNameTemplate, nameTemplate, strList[0].toString(), commentTemplate);
-
-        qCDebug(RUNNER_SERVICES) << "Final query : " << finalQuery;
-        return finalQuery;
+        return (!indexed.keywords.isEmpty() && listContainsAll(indexed.keywords, words))
+            || (!indexed.genericName.isEmpty() && containsAll(indexed.genericName, words))
+            || (!indexed.name.isEmpty() && containsAll(indexed.name, words))
+            || indexed.exec.contains(firstWord)
+            || (!indexed.comment.isEmpty() && containsAll(indexed.comment, words));
     }
 
     void setupMatch(const KService::Ptr &service, Plasma::QueryMatch &match)
@@ -187,10 +280,12 @@ private:
         }
 
         // Search for applications which are executable and case-insensitively match the search term
-        // See https://techbase.kde.org/Development/Tutorials/Services/Traders#The_KTrader_Query_Language
-        // if the following is unclear to you.
-        query = QStringLiteral("exist Exec and ('%1' =~ Name)").arg(term);
-        KService::List services = KServiceTypeTrader::self()->query(QStringLiteral("Application"), query);
+        KService::List services;
+        for (const IndexedService &indexed : m_index->applications()) {
+            if (!indexed.exec.isEmpty() && indexed.name == foldedTerm) {
+                services << indexed.service;
+            }
+        }
 
         if (services.isEmpty()) {
             return;
@@ -214,18 +309,35 @@ private:
         //Splitting the query term to match using subsequences
         QVector<QStringRef> queryList = term.splitRef(QLatin1Char(' '));
 
-        // If the term length is < 3, no real point searching the Keywords and GenericName
-        if (weightedTermLength < 3) {
-            query = QStringLiteral("exist Exec and ( (exist Name and '%1' ~~ Name) or ('%1' ~~ Exec) )").arg(term);
-        } else {
-            //Match using subsequences (Bug: 262837)
-            query = generateQuery(queryList);
+        QVector<QString> foldedWords;
+        foldedWords.reserve(queryList.count());
+        for (const QStringRef &word : qAsConst(queryList)) {
+            foldedWords << word.toString().toCaseFolded();
         }
 
-        KService::List services = KServiceTypeTrader::self()->query(QStringLiteral("Application"), query);
-        services += KServiceTypeTrader::self()->query(QStringLiteral("KCModule"), query);
+        auto matches = [this, &foldedWords](const IndexedService &indexed) {
+            // If the term length is < 3, no real point searching the Keywords and GenericName
+            if (weightedTermLength < 3) {
+                return !indexed.exec.isEmpty()
+                    && ((!indexed.name.isEmpty() && indexed.name.contains(foldedTerm)) || indexed.exec.contains(foldedTerm));
+            }
+            //Match using subsequences (Bug: 262837)
+            return matchesWords(indexed, foldedWords, foldedWords.first());
+        };
+
+        KService::List services;
+        for (const IndexedService &indexed : m_index->applications()) {
+            if (matches(indexed)) {
+                services << indexed.service;
+            }
+        }
+        for (const IndexedService &indexed : m_index->kcms()) {
+            if (matches(indexed)) {
+                services << indexed.service;
+            }
+        }
 
-        qCDebug(RUNNER_SERVICES) << "got " << services.count() << " services from " << query;
+        qCDebug(RUNNER_SERVICES) << "got " << services.count() << " services for " << term;
         foreach (const KService::Ptr &service, services) {
             if (disqualify(service)) {
                 continue;
@@ -295,8 +407,12 @@ private:
     void matchCategories()
     {
         //search for applications whose categories contains the query
-        query = QStringLiteral("exist Exec and (exist Categories and '%1' ~subin Categories)").arg(term);
-        auto services = KServiceTypeTrader::self()->query(QStringLiteral("Application"), query);
+        KService::List services;
+        for (const IndexedService &indexed : m_index->applications()) {
+            if (!indexed.exec.isEmpty() && listContains(indexed.categories, foldedTerm)) {
+                services << indexed.service;
+            }
+        }
 
         foreach (const KService::Ptr &service, services) {
             qCDebug(RUNNER_SERVICES) << service->name() << "is an exact match!" << service->storageId() << service->exec();
@@ -329,10 +445,8 @@ private:
             return;
         }
 
-        query = QStringLiteral("exist Actions"); // doesn't work
-        auto services = KServiceTypeTrader::self()->query(QStringLiteral("Application"));//, query);
-
-        foreach (const KService::Ptr &service, services) {
+        for (const IndexedService &indexed : m_index->applications()) {
+            const KService::Ptr &service = indexed.service;
             if (service->noDisplay()) {
                 continue;
             }
@@ -372,11 +486,12 @@ private:
     }
 
     ServiceRunner *m_runner;
+    QSharedPointer<const ServiceIndex> m_index;
     QSet<QString> m_seen;
 
     QList<Plasma::QueryMatch> matches;
-    QString query;
     QString term;
+    QString foldedTerm;
     int weightedTermLength;
 };
 
@@ -389,6 +504,8 @@ ServiceRunner::ServiceRunner(QObject *parent, const QVariantList &args)
     setPriority(AbstractRunner::HighestPriority);
 
     addSyntax(Plasma::RunnerSyntax(QStringLiteral(":q:"), i18n("Finds applications whose name or description match :q:")));
+
+    connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), this, SLOT(invalidateIndex()));
 }
 
 ServiceRunner::~ServiceRunner()
@@ -419,10 +536,29 @@ void ServiceRunner::match(Plasma::RunnerContext &context)
 {
     // This helper class aids in keeping state across numerous
     // different queries that together form the matches set.
-    ServiceFinder finder(this);
+    ServiceFinder finder(this, serviceIndex());
     finder.match(context);
 }
 
+QSharedPointer<const ServiceIndex> ServiceRunner::serviceIndex()
+{
+    QMutexLocker locker(&m_indexMutex);
+
+    if (!m_index) {
+        m_index.reset(new ServiceIndex);
+    }
+
+    return m_index;
+}
+
+void ServiceRunner::invalidateIndex()
+{
+    QMutexLocker locker(&m_indexMutex);
+
+    // Queries still running keep using the old snapshot
+    m_index.reset();
+}
+
 void ServiceRunner::run(const Plasma::RunnerContext &context, const Plasma::QueryMatch &match)
 {
     Q_UNUSED(context);
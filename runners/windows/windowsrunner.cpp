@@ -37,7 +37,8 @@ K_EXPORT_PLASMA_RUNNER(windows, WindowsRunner)
 
 WindowsRunner::WindowsRunner(QObject* parent, const QVariantList& args)
     : AbstractRunner(parent, args),
-      m_inSession(false),
+      m_currentDesktop(1),
+      m_tracking(false),
       m_ready(false)
 {
     Q_UNUSED(args)
@@ -60,75 +61,146 @@ WindowsRunner::WindowsRunner(QObject* parent, const QVariantList& args)
                                    i18n("Lists all other desktops and allows to switch to them.")));
 
     connect(this, &Plasma::AbstractRunner::prepare, this, &WindowsRunner::prepareForMatchSession);
-    connect(this, &Plasma::AbstractRunner::teardown, this, &WindowsRunner::matchSessionComplete);
 }
 
 WindowsRunner::~WindowsRunner()
 {
 }
 
+static const NET::Properties s_windowProperties = NET::WMWindowType | NET::WMDesktop | NET::WMState | NET::XAWMState | NET::WMName;
+static const NET::Properties2 s_windowProperties2 = NET::WM2WindowClass | NET::WM2WindowRole | NET::WM2AllowedActions;
+
 // Called in the main thread
 void WindowsRunner::gatherInfo()
 {
+    foreach (const WId w, KWindowSystem::windows()) {
+        updateWindow(w);
+    }
+    updateDesktopNames();
+    updateCurrentDesktop();
+
     QMutexLocker locker(&m_mutex);
-    if (!m_inSession) {
-        return;
+    m_ready = true;
+}
+
+// Called in the main thread
+void WindowsRunner::updateWindow(WId w)
+{
+    KWindowInfo info(w, s_windowProperties, s_windowProperties2);
+    bool wanted = info.valid();
+    if (wanted) {
+        // ignore NET::Tool and other special window types
+        NET::WindowType wType = info.windowType(NET::NormalMask | NET::DesktopMask | NET::DockMask |
+                                                NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
+                                                NET::OverrideMask | NET::TopMenuMask |
+                                                NET::UtilityMask | NET::SplashMask);
+
+        wanted = wType == NET::Normal || wType == NET::Override || wType == NET::Unknown ||
+                 wType == NET::Dialog || wType == NET::Utility;
     }
 
-    foreach (const WId w, KWindowSystem::windows()) {
-        KWindowInfo info(w, NET::WMWindowType | NET::WMDesktop |
-                                                        NET::WMState | NET::XAWMState |
-                                                        NET::WMName,
-                                                    NET::WM2WindowClass | NET::WM2WindowRole | NET::WM2AllowedActions);
-        if (info.valid()) {
-            // ignore NET::Tool and other special window types
-            NET::WindowType wType = info.windowType(NET::NormalMask | NET::DesktopMask | NET::DockMask |
-                                                    NET::ToolbarMask | NET::MenuMask | NET::DialogMask |
-                                                    NET::OverrideMask | NET::TopMenuMask |
-                                                    NET::UtilityMask | NET::SplashMask);
-
-            if (wType != NET::Normal && wType != NET::Override && wType != NET::Unknown &&
-                wType != NET::Dialog && wType != NET::Utility) {
-                continue;
-            }
-            m_windows.insert(w, info);
-            m_icons.insert(w, QIcon(KWindowSystem::icon(w)));
+    // Icons are resolved here, match() must not talk to X nor create pixmaps.
+    // m_icons is only written in the main thread, no need to lock for reading it
+    QIcon icon;
+    const bool fetchIcon = wanted && !m_icons.contains(w);
+    if (fetchIcon) {
+        icon = QIcon(KWindowSystem::icon(w));
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (wanted) {
+        m_windows.insert(w, info);
+        if (fetchIcon) {
+            m_icons.insert(w, icon);
         }
+    } else {
+        m_windows.remove(w);
+        m_icons.remove(w);
     }
+}
 
-    for (int i=1; i<=KWindowSystem::numberOfDesktops(); i++) {
-        m_desktopNames << KWindowSystem::desktopName(i);
+// Called in the main thread
+void WindowsRunner::windowRemoved(WId w)
+{
+    QMutexLocker locker(&m_mutex);
+    m_windows.remove(w);
+    m_icons.remove(w);
+}
+
+// Called in the main thread
+void WindowsRunner::windowChanged(WId w, NET::Properties properties, NET::Properties2 properties2)
+{
+    if ((properties & NET::WMIcon || properties2 & NET::WM2IconPixmap) && m_windows.contains(w)) {
+        const QIcon icon(KWindowSystem::icon(w));
+
+        QMutexLocker locker(&m_mutex);
+        m_icons.insert(w, icon);
     }
 
-    m_ready = true;
+    if (properties & s_windowProperties || properties2 & s_windowProperties2) {
+        updateWindow(w);
+    }
 }
 
 // Called in the main thread
-void WindowsRunner::prepareForMatchSession()
+void WindowsRunner::updateDesktopNames()
 {
+    QStringList desktopNames;
+    for (int i=1; i<=KWindowSystem::numberOfDesktops(); i++) {
+        desktopNames << KWindowSystem::desktopName(i);
+    }
+
     QMutexLocker locker(&m_mutex);
-    m_inSession = true;
-    m_ready = false;
-    QTimer::singleShot(0, this, &WindowsRunner::gatherInfo);
+    m_desktopNames = desktopNames;
 }
 
 // Called in the main thread
-void WindowsRunner::matchSessionComplete()
+void WindowsRunner::updateCurrentDesktop()
 {
+    const int currentDesktop = KWindowSystem::currentDesktop();
+
     QMutexLocker locker(&m_mutex);
-    m_inSession = false;
-    m_ready = false;
-    m_desktopNames.clear();
-    m_icons.clear();
-    m_windows.clear();
+    m_currentDesktop = currentDesktop;
+}
+
+// Called in the main thread
+void WindowsRunner::prepareForMatchSession()
+{
+    if (m_tracking) {
+        return;
+    }
+    m_tracking = true;
+
+    // Start following the window changes the first time we are used,
+    // from then on a match session doesn't need to ask X about every window
+    connect(KWindowSystem::self(), &KWindowSystem::windowAdded, this, &WindowsRunner::updateWindow);
+    connect(KWindowSystem::self(), &KWindowSystem::windowRemoved, this, &WindowsRunner::windowRemoved);
+    connect(KWindowSystem::self(), static_cast<void (KWindowSystem::*)(WId, NET::Properties, NET::Properties2)>(&KWindowSystem::windowChanged),
+            this, &WindowsRunner::windowChanged);
+    connect(KWindowSystem::self(), &KWindowSystem::desktopNamesChanged, this, &WindowsRunner::updateDesktopNames);
+    connect(KWindowSystem::self(), &KWindowSystem::numberOfDesktopsChanged, this, &WindowsRunner::updateDesktopNames);
+    connect(KWindowSystem::self(), &KWindowSystem::currentDesktopChanged, this, &WindowsRunner::updateCurrentDesktop);
+
+    QTimer::singleShot(0, this, &WindowsRunner::gatherInfo);
 }
 
 // Called in the secondary thread
 void WindowsRunner::match(Plasma::RunnerContext& context)
 {
-    QMutexLocker locker(&m_mutex);
-    if (!m_ready) {
-        return;
+    // Everything match needs from KWindowSystem comes from this snapshot
+    QHash<WId, KWindowInfo> windows;
+    QHash<WId, QIcon> icons;
+    QStringList desktopNames;
+    int currentDesktop;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_ready) {
+            return;
+        }
+        windows = m_windows;
+        icons = m_icons;
+        desktopNames = m_desktopNames;
+        currentDesktop = m_currentDesktop;
     }
 
     QString term = context.query();
@@ -193,7 +265,7 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
             } else if (keyword.startsWith(i18nc("Note this is a KRunner keyword", "desktop") + QStringLiteral("=") , Qt::CaseInsensitive)) {
                 bool ok;
                 desktop = keyword.split(QStringLiteral("="))[1].toInt(&ok);
-                if (!ok || desktop > KWindowSystem::numberOfDesktops()) {
+                if (!ok || desktop > desktopNames.count()) {
                     desktop = -1; // sanity check
                 }
             } else {
@@ -204,7 +276,7 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
                 }
             }
         }
-        QHashIterator<WId, KWindowInfo> it(m_windows);
+        QHashIterator<WId, KWindowInfo> it(windows);
         while(it.hasNext()) {
             it.next();
             WId w = it.key();
@@ -212,9 +284,6 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
             QString windowClassCompare = QString::fromUtf8(info.windowClassName()) + QLatin1Char(' ') +
                                          QString::fromUtf8(info.windowClassClass());
             // exclude not matching windows
-            if (!KWindowSystem::hasWId(w)) {
-                continue;
-            }
             if (!windowName.isEmpty() && !info.name().contains(windowName, Qt::CaseInsensitive)) {
                 continue;
             }
@@ -239,7 +308,7 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
             }
             // blacklisted everything else: we have a match
             if (actionSupported(info, action)){
-                matches << windowMatch(info, action);
+                matches << windowMatch(desktopNames, currentDesktop, info, icons.value(w), action);
             }
         }
 
@@ -256,62 +325,59 @@ void WindowsRunner::match(Plasma::RunnerContext& context)
         const QStringList parts = term.split(QLatin1Char(' '));
         if (parts.size() == 1) {
             // only keyword - list all desktops
-            for (int i=1; i<=KWindowSystem::numberOfDesktops(); i++) {
-                if (i == KWindowSystem::currentDesktop()) {
+            for (int i=1; i<=desktopNames.count(); i++) {
+                if (i == currentDesktop) {
                     continue;
                 }
-                matches << desktopMatch(i);
+                matches << desktopMatch(desktopNames, i);
                 desktopAdded = true;
             }
         } else {
             // keyword + desktop - restrict matches
             bool isInt;
             int desktop = term.midRef(parts[0].length() + 1).toInt(&isInt);
-            if (isInt && desktop != KWindowSystem::currentDesktop()) {
-                matches << desktopMatch(desktop);
+            if (isInt && desktop >= 1 && desktop <= desktopNames.count() && desktop != currentDesktop) {
+                matches << desktopMatch(desktopNames, desktop);
                 desktopAdded = true;
             }
         }
     }
 
     // check for matches without keywords
-    QHashIterator<WId, KWindowInfo> it(m_windows);
+    QHashIterator<WId, KWindowInfo> it(windows);
     while (it.hasNext()) {
         it.next();
         WId w = it.key();
-        if (!KWindowSystem::hasWId(w)) {
-            continue;
-        }
         // check if window name, class or role contains the query
         KWindowInfo info = it.value();
         QString className = QString::fromUtf8(info.windowClassName());
         if (info.name().startsWith(term, Qt::CaseInsensitive) ||
             className.startsWith(term, Qt::CaseInsensitive)) {
-            matches << windowMatch(info, action, 0.8, Plasma::QueryMatch::ExactMatch);
+            matches << windowMatch(desktopNames, currentDesktop, info, icons.value(w), action, 0.8, Plasma::QueryMatch::ExactMatch);
         } else if ((info.name().contains(term, Qt::CaseInsensitive) ||
              className.contains(term, Qt::CaseInsensitive)) && 
             actionSupported(info, action)) {
-            matches << windowMatch(info, action, 0.7, Plasma::QueryMatch::PossibleMatch);
+            matches << windowMatch(desktopNames, currentDesktop, info, icons.value(w), action, 0.7, Plasma::QueryMatch::PossibleMatch);
         }
     }
 
     // check for matching desktops by name
-    foreach (const QString& desktopName, m_desktopNames) {
-        int desktop = m_desktopNames.indexOf(desktopName) +1;
+    foreach (const QString& desktopName, desktopNames) {
+        int desktop = desktopNames.indexOf(desktopName) +1;
         if (desktopName.contains(term, Qt::CaseInsensitive)) {
             // desktop name matches - offer switch to
             // only add desktops if it hasn't been added by the keyword which is quite likely
-            if (!desktopAdded && desktop != KWindowSystem::currentDesktop()) {
-                matches << desktopMatch(desktop, 0.8);
+            if (!desktopAdded && desktop != currentDesktop) {
+                matches << desktopMatch(desktopNames, desktop, 0.8);
             }
 
             // search for windows on desktop and list them with less relevance
-            QHashIterator<WId, KWindowInfo> it(m_windows);
+            QHashIterator<WId, KWindowInfo> it(windows);
             while (it.hasNext()) {
                 it.next();
                 KWindowInfo info = it.value();
                 if (info.isOnDesktop(desktop) && actionSupported(info, action)) {
-                    matches << windowMatch(info, action, 0.5, Plasma::QueryMatch::PossibleMatch);
+                    matches << windowMatch(desktopNames, currentDesktop, info, icons.value(it.key()), action, 0.5, Plasma::QueryMatch::PossibleMatch);
                 }
             }
         }
@@ -398,7 +464,7 @@ void WindowsRunner::run(const Plasma::RunnerContext& context, const Plasma::Quer
     }
 }
 
-Plasma::QueryMatch WindowsRunner::desktopMatch(int desktop, qreal relevance)
+Plasma::QueryMatch WindowsRunner::desktopMatch(const QStringList &desktopNames, int desktop, qreal relevance)
 {
     Plasma::QueryMatch match(this);
     match.setType(Plasma::QueryMatch::ExactMatch);
@@ -406,10 +472,8 @@ Plasma::QueryMatch WindowsRunner::desktopMatch(int desktop, qreal relevance)
     match.setId(QStringLiteral("desktop-") + QString::number(desktop));
     match.setIconName(QStringLiteral("user-desktop"));
     QString desktopName;
-    if (desktop <= m_desktopNames.size()) {
-        desktopName = m_desktopNames[desktop - 1];
-    } else {
-        desktopName = KWindowSystem::desktopName(desktop);
+    if (desktop >= 1 && desktop <= desktopNames.size()) {
+        desktopName = desktopNames[desktop - 1];
     }
     match.setText(desktopName);
     match.setSubtext(i18n("Switch to desktop %1", desktop));
@@ -417,22 +481,21 @@ Plasma::QueryMatch WindowsRunner::desktopMatch(int desktop, qreal relevance)
     return match;
 }
 
-Plasma::QueryMatch WindowsRunner::windowMatch(const KWindowInfo& info, WindowAction action, qreal relevance, Plasma::QueryMatch::Type type)
+Plasma::QueryMatch WindowsRunner::windowMatch(const QStringList &desktopNames, int currentDesktop, const KWindowInfo& info, const QIcon &icon,
+                                              WindowAction action, qreal relevance, Plasma::QueryMatch::Type type)
 {
     Plasma::QueryMatch match(this);
     match.setType(type);
     match.setData(QString(QString::number((int)action) + QLatin1Char('_') + QString::number(info.win())));
-    match.setIcon(m_icons[info.win()]);
+    match.setIcon(icon);
     match.setText(info.name());
     QString desktopName;
     int desktop = info.desktop();
     if (desktop == NET::OnAllDesktops) {
-        desktop = KWindowSystem::currentDesktop();
+        desktop = currentDesktop;
     }
-    if (desktop <= m_desktopNames.size()) {
-        desktopName = m_desktopNames[desktop - 1];
-    } else {
-        desktopName = KWindowSystem::desktopName(desktop);
+    if (desktop >= 1 && desktop <= desktopNames.size()) {
+        desktopName = desktopNames[desktop - 1];
     }
     switch (action) {
     case CloseAction:
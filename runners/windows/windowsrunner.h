@@ -23,7 +23,7 @@
 
 #include <QMutex>
 
-class KWindowInfo;
+#include <KWindowInfo>
 
 class WindowsRunner : public Plasma::AbstractRunner
 {
@@ -38,8 +38,12 @@ class WindowsRunner : public Plasma::AbstractRunner
 
     private Q_SLOTS:
         void prepareForMatchSession();
-        void matchSessionComplete();
         void gatherInfo();
+        void updateWindow(WId w);
+        void windowRemoved(WId w);
+        void windowChanged(WId w, NET::Properties properties, NET::Properties2 properties2);
+        void updateDesktopNames();
+        void updateCurrentDesktop();
 
     private:
         enum WindowAction {
@@ -52,18 +56,22 @@ class WindowsRunner : public Plasma::AbstractRunner
             KeepAboveAction,
             KeepBelowAction
         };
-        Plasma::QueryMatch desktopMatch(int desktop, qreal relevance = 1.0);
-        Plasma::QueryMatch windowMatch(const KWindowInfo& info, WindowAction action, qreal relevance = 1.0,
+        Plasma::QueryMatch desktopMatch(const QStringList &desktopNames, int desktop, qreal relevance = 1.0);
+        Plasma::QueryMatch windowMatch(const QStringList &desktopNames, int currentDesktop, const KWindowInfo& info, const QIcon &icon,
+                                       WindowAction action, qreal relevance = 1.0,
                                        Plasma::QueryMatch::Type type = Plasma::QueryMatch::ExactMatch);
         bool actionSupported(const KWindowInfo& info, WindowAction action);
 
+        // Once the first match session started, the window table is kept up to date
+        // with the changes KWindowSystem reports, matches work on a copy of it
         QHash<WId, KWindowInfo> m_windows; // protected by m_mutex
-        QHash<WId, QIcon> m_icons; // protected by m_mutex
+        QHash<WId, QIcon> m_icons; // protected by m_mutex, resolved in the main thread
         QStringList m_desktopNames; // protected by m_mutex
+        int m_currentDesktop; // protected by m_mutex
         QMutex m_mutex;
 
-        bool m_inSession : 1; // only used in the main thread
-        bool m_ready : 1; // protected by m_mutex
+        bool m_tracking; // only used in the main thread
+        bool m_ready; // protected by m_mutex, not a bitfield sharing memory with m_tracking
 };
 
 #endif // WINDOWSRUNNER_H
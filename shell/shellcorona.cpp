@@ -80,6 +80,7 @@
 #include "scripting/scriptengine.h"
 #include "osd.h"
 #include "screenpool.h"
+#include "startuptrace.h"
 
 #include "plasmashelladaptor.h"
 #include "debug.h"
@@ -109,7 +110,8 @@ ShellCorona::ShellCorona(QObject *parent)
       m_interactiveConsole(nullptr),
       m_waylandPlasmaShell(nullptr),
       m_closingDown(false),
-      m_strutManager(new StrutManager(this))
+      m_strutManager(new StrutManager(this)),
+      m_startupTrace(new StartupTrace(this))
 {
     setupWaylandIntegration();
     qmlRegisterUncreatableType<DesktopView>("org.kde.plasma.shell", 2, 0, "Desktop", QStringLiteral("It is not possible to create objects of type Desktop"));
@@ -182,6 +184,28 @@ ShellCorona::ShellCorona(QObject *parent)
     checkAddPanelAction();
     connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), this, SLOT(checkAddPanelAction(QStringList)));
 
+    //panel containments and layout templates are KPackages, which are not in sycoca:
+    //watch their install directories so the cached lists don't go stale
+    m_panelPackagesChangedTimer.setSingleShot(true);
+    m_panelPackagesChangedTimer.setInterval(1000);
+    connect(&m_panelPackagesChangedTimer, &QTimer::timeout, this, [this]() {
+        checkAddPanelAction();
+    });
+    KDirWatch *panelPackagesWatch = new KDirWatch(this);
+    const QString localDataDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QLatin1Char('/');
+    const QStringList packageDirs = {QStringLiteral("plasma/plasmoids"), QStringLiteral("plasma/layout-templates")};
+    for (const QString &packageDir : packageDirs) {
+        //the local one may not exist yet, KDirWatch reports when it gets created
+        panelPackagesWatch->addDir(localDataDir + packageDir);
+        const QStringList dirs = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, packageDir, QStandardPaths::LocateDirectory);
+        for (const QString &dir : dirs) {
+            panelPackagesWatch->addDir(dir);
+        }
+    }
+    connect(panelPackagesWatch, &KDirWatch::dirty, &m_panelPackagesChangedTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(panelPackagesWatch, &KDirWatch::created, &m_panelPackagesChangedTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(panelPackagesWatch, &KDirWatch::deleted, &m_panelPackagesChangedTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+
 
     //Activity stuff
     QAction *activityAction = actions()->addAction(QStringLiteral("manage activities"));
@@ -431,6 +455,11 @@ QJsonObject dumpconfigGroupJS(const KConfigGroup &rootGroup)
     return result;
 }
 
+QString ShellCorona::startupTrace() const
+{
+    return QString::fromUtf8(m_startupTrace->toJson());
+}
+
 QByteArray ShellCorona::dumpCurrentLayoutJS() const
 {
     QJsonObject root;
@@ -695,6 +724,8 @@ void ShellCorona::load()
 
     disconnect(m_activityController, &KActivities::Controller::serviceStatusChanged, this, &ShellCorona::load);
 
+    StartupTrace::Phase tracePhase(m_startupTrace, QStringLiteral("load"));
+
     m_screenPool->load();
 
     //TODO: a kconf_update script is needed
@@ -1245,6 +1276,8 @@ void ShellCorona::reconsiderOutputs()
 void ShellCorona::addOutput(QScreen* screen)
 {
     Q_ASSERT(screen);
+    StartupTrace::Phase tracePhase(m_startupTrace, QStringLiteral("addOutput"));
+
     connect(screen, &QScreen::geometryChanged,
             &m_reconsiderOutputsTimer, static_cast<void (QTimer::*)()>(&QTimer::start),
             Qt::UniqueConnection);
@@ -1288,6 +1321,7 @@ void ShellCorona::addOutput(QScreen* screen)
     m_screenPool->insertScreenMapping(insertPosition, screen->name());
     m_desktopViewforId[insertPosition] = view;
     view->setContainment(containment);
+    m_startupTrace->watchFirstFrame(insertPosition, view);
     view->show();
     Q_ASSERT(screen == view->screen());
 
@@ -1322,6 +1356,8 @@ void ShellCorona::checkAllDesktopsUiReady(bool ready)
         ksplashProgressMessage.setArguments(QList<QVariant>() << QStringLiteral("desktop"));
         QDBusConnection::sessionBus().asyncCall(ksplashProgressMessage);
     }
+
+    m_startupTrace->finish();
 }
 
 Plasma::Containment *ShellCorona::createContainmentForActivity(const QString& activity, int screenNum)
@@ -1355,6 +1391,7 @@ Plasma::Containment *ShellCorona::createContainmentForActivity(const QString& ac
 
 void ShellCorona::createWaitingPanels()
 {
+    StartupTrace::Phase tracePhase(m_startupTrace, QStringLiteral("createWaitingPanels"));
     QList<Plasma::Containment *> stillWaitingPanels;
 
     for (Plasma::Containment *cont : qAsConst(m_waitingPanels)) {
@@ -1405,6 +1442,16 @@ void ShellCorona::panelContainmentDestroyed(QObject *cont)
 
 void ShellCorona::handleContainmentAdded(Plasma::Containment *c)
 {
+    // Applets restored with the layout were added before the containment was announced.
+    // They are still open on top of it, latest first
+    const auto applets = c->applets();
+    for (auto it = applets.crbegin(); it != applets.crend(); ++it) {
+        m_startupTrace->endCreation((*it)->pluginMetaData().pluginId(), false);
+    }
+    m_startupTrace->endCreation(c->pluginMetaData().pluginId(), true);
+    connect(c, &Plasma::Containment::appletAdded, this, [this] (Plasma::Applet *applet) {
+        m_startupTrace->endCreation(applet->pluginMetaData().pluginId(), false);
+    });
     connect(c, &Plasma::Containment::showAddWidgetsInterface,
             this, &ShellCorona::toggleWidgetExplorer);
     connect(c, &Plasma::Containment::appletAlternativesRequested,
@@ -1800,19 +1847,21 @@ void ShellCorona::checkAddPanelAction(const QStringList &sycocaChanges)
 
     m_addPanelsMenu.reset(nullptr);
 
-    KPluginInfo::List panelContainmentPlugins = Plasma::PluginLoader::listContainmentsOfType(QStringLiteral("Panel"));
+    //these scan all the installed plugins and packages: do it once here and reuse the results
+    //in populateAddPanelsMenu() and addPanel() until the next sycoca or package directory change
+    m_panelContainmentPlugins = Plasma::PluginLoader::listContainmentsOfType(QStringLiteral("Panel"));
 
     auto filter = [](const KPluginMetaData &md) -> bool
     {
         return md.value(QStringLiteral("NoDisplay")) != QLatin1String("true") && KPluginMetaData::readStringList(md.rawData(), QStringLiteral("X-Plasma-ContainmentCategories")).contains(QLatin1String("panel"));
     };
-    QList<KPluginMetaData> templates = KPackage::PackageLoader::self()->findPackages(QStringLiteral("Plasma/LayoutTemplate"), QString(), filter);
+    m_panelLayoutTemplates = KPackage::PackageLoader::self()->findPackages(QStringLiteral("Plasma/LayoutTemplate"), QString(), filter);
 
-    if (panelContainmentPlugins.count() + templates.count() == 1) {
+    if (m_panelContainmentPlugins.count() + m_panelLayoutTemplates.count() == 1) {
         m_addPanelAction = new QAction(i18n("Add Panel"), this);
         m_addPanelAction->setData(Plasma::Types::AddAction);
         connect(m_addPanelAction, SIGNAL(triggered(bool)), this, SLOT(addPanel()));
-    } else if (!panelContainmentPlugins.isEmpty()) {
+    } else if (!m_panelContainmentPlugins.isEmpty()) {
         m_addPanelsMenu.reset(new QMenu);
         m_addPanelAction = m_addPanelsMenu->menuAction();
         m_addPanelAction->setText(i18n("Add Panel"));
@@ -1832,21 +1881,15 @@ void ShellCorona::populateAddPanelsMenu()
     m_addPanelsMenu->clear();
     const KPluginInfo emptyInfo;
 
-    const KPluginInfo::List panelContainmentPlugins = Plasma::PluginLoader::listContainmentsOfType(QStringLiteral("Panel"));
     QMap<QString, QPair<KPluginInfo, KPluginMetaData> > sorted;
-    for (const KPluginInfo &plugin : panelContainmentPlugins) {
+    for (const KPluginInfo &plugin : qAsConst(m_panelContainmentPlugins)) {
         if (plugin.property(QStringLiteral("NoDisplay")).toString() == QLatin1String("true")) {
             continue;
         }
         sorted.insert(plugin.name(), qMakePair(plugin, KPluginMetaData()));
     }
 
-    auto filter = [](const KPluginMetaData &md) -> bool
-    {
-        return md.value(QStringLiteral("NoDisplay")) != QLatin1String("true") && KPluginMetaData::readStringList(md.rawData(), QStringLiteral("X-Plasma-ContainmentCategories")).contains(QLatin1String("panel"));
-    };
-    const QList<KPluginMetaData> templates = KPackage::PackageLoader::self()->findPackages(QStringLiteral("Plasma/LayoutTemplate"), QString(), filter);
-    for (auto tpl : templates) {
+    for (const auto &tpl : qAsConst(m_panelLayoutTemplates)) {
         sorted.insert(tpl.name(), qMakePair(emptyInfo, tpl));
     }
 
@@ -1877,10 +1920,8 @@ void ShellCorona::populateAddPanelsMenu()
 
 void ShellCorona::addPanel()
 {
-    KPluginInfo::List panelPlugins = Plasma::PluginLoader::listContainmentsOfType(QStringLiteral("Panel"));
-
-    if (!panelPlugins.isEmpty()) {
-        addPanel(panelPlugins.first().pluginName());
+    if (!m_panelContainmentPlugins.isEmpty()) {
+        addPanel(m_panelContainmentPlugins.first().pluginName());
     }
 }
 
@@ -2043,6 +2084,7 @@ void ShellCorona::stopCurrentActivity()
 
 void ShellCorona::insertContainment(const QString &activity, int screenNum, Plasma::Containment *containment)
 {
+    StartupTrace::Phase tracePhase(m_startupTrace, QStringLiteral("insertContainment"));
     Plasma::Containment *cont = nullptr;
     auto candidates = containmentsForActivity(activity);
     for (Plasma::Containment *c : candidates) {
@@ -32,12 +32,15 @@
 #include <QDBusContext>
 
 #include <KPackage/Package>
+#include <KPluginInfo>
+#include <KPluginMetaData>
 
 class DesktopView;
 class PanelView;
 class QMenu;
 class QScreen;
 class ScreenPool;
+class StartupTrace;
 class StrutManager;
 
 namespace KActivities
@@ -153,6 +156,12 @@ public Q_SLOTS:
 
     QByteArray dumpCurrentLayoutJS() const;
 
+    /**
+     * @returns a JSON report of how long the startup phases took,
+     * and of the time and memory each containment and applet plugin cost while starting
+     */
+    QString startupTrace() const;
+
     /**
      * loads the shell layout from a look and feel package,
      * resetting it to the default layout exported in the
@@ -250,6 +259,10 @@ private:
     QHash<QString, QString> m_activityContainmentPlugins;
     QAction *m_addPanelAction;
     QScopedPointer<QMenu> m_addPanelsMenu;
+    //panel containments and panel layout templates, refreshed on sycoca changes
+    //and when their package directories change
+    KPluginInfo::List m_panelContainmentPlugins;
+    QList<KPluginMetaData> m_panelLayoutTemplates;
     KPackage::Package m_lookAndFeelPackage;
     QSet<QScreen*> m_redundantOutputs;
     KDeclarative::QmlObjectSharedEngine *m_interactiveConsole;
@@ -257,12 +270,14 @@ private:
     QTimer m_waitingPanelsTimer;
     QTimer m_appConfigSyncTimer;
     QTimer m_reconsiderOutputsTimer;
+    QTimer m_panelPackagesChangedTimer;
 
     KWayland::Client::PlasmaShell *m_waylandPlasmaShell;
     bool m_closingDown : 1;
     QString m_testModeLayout;
 
     StrutManager *m_strutManager;
+    StartupTrace *m_startupTrace;
 };
 
 #endif // SHELLCORONA_H
@@ -0,0 +1,320 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Library General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "startuptrace.h"
+#include "debug.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QSharedPointer>
+
+#include <Plasma/PluginLoader>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// How long the report waits for the screens that didn't show a frame yet
+static const int s_firstFramesTimeout = 10000;
+
+static qint64 toMsecs(qint64 nsecs)
+{
+    return nsecs / 1000000;
+}
+
+namespace {
+
+/**
+ * Every containment and applet is created through PluginLoader::loadApplet,
+ * which asks internalLoadApplet first: that's where a creation starts
+ */
+class TracingPluginLoader : public Plasma::PluginLoader
+{
+public:
+    explicit TracingPluginLoader(StartupTrace *trace)
+        : m_trace(trace)
+    {
+    }
+
+protected:
+    Plasma::Applet *internalLoadApplet(const QString &name, uint appletId, const QVariantList &args) override
+    {
+        Q_UNUSED(appletId)
+        Q_UNUSED(args)
+
+        if (m_trace) {
+            m_trace->beginCreation(name);
+        }
+        // let the default implementation create it
+        return nullptr;
+    }
+
+private:
+    QPointer<StartupTrace> m_trace;
+};
+
+}
+
+StartupTrace::StartupTrace(QObject *parent)
+    : QObject(parent)
+{
+    m_clock.start();
+
+    m_firstFramesTimeout.setSingleShot(true);
+    m_firstFramesTimeout.setInterval(s_firstFramesTimeout);
+    connect(&m_firstFramesTimeout, &QTimer::timeout, this, &StartupTrace::writeReport);
+
+    // Must happen before anything asks for PluginLoader::self(), otherwise this is ignored
+    // and creations are not charged. The loader lives as long as the process
+    Plasma::PluginLoader::setPluginLoader(new TracingPluginLoader(this));
+}
+
+StartupTrace::~StartupTrace()
+{
+}
+
+bool StartupTrace::beginPhase(const QString &name)
+{
+    if (m_finished) {
+        return false;
+    }
+
+    PhaseTiming phase;
+    phase.name = name;
+    phase.start = m_clock.nsecsElapsed();
+    m_phases << phase;
+
+    ++m_depth;
+    return true;
+}
+
+void StartupTrace::endPhase(const QString &name)
+{
+    for (auto it = m_phases.rbegin(); it != m_phases.rend(); ++it) {
+        if (it->name == name && it->duration < 0) {
+            it->duration = m_clock.nsecsElapsed() - it->start;
+            break;
+        }
+    }
+
+    m_depth = qMax(0, m_depth - 1);
+}
+
+void StartupTrace::beginCreation(const QString &pluginId)
+{
+    if (m_depth == 0 || m_finished) {
+        return;
+    }
+
+    Creation creation;
+    creation.pluginId = pluginId;
+    creation.start = m_clock.nsecsElapsed();
+    creation.startMemory = residentMemory();
+    m_creations << creation;
+}
+
+void StartupTrace::endCreation(const QString &pluginId, bool containment)
+{
+    if (m_depth == 0 || m_finished) {
+        return;
+    }
+
+    int index = m_creations.count() - 1;
+    while (index >= 0 && m_creations.at(index).pluginId != pluginId) {
+        --index;
+    }
+    if (index < 0) {
+        // not created through the plugin loader
+        return;
+    }
+
+    // the ones started after it never got added, e.g. because they failed to load
+    const Creation creation = m_creations.at(index);
+    m_creations.resize(index);
+
+    const qint64 nsecs = m_clock.nsecsElapsed() - creation.start;
+    const qint64 memory = residentMemory() - creation.startMemory;
+
+    PluginCost &cost = m_costs[pluginId];
+    cost.containment = containment;
+    ++cost.count;
+    cost.nsecs += nsecs - creation.nestedNsecs;
+    cost.memory += memory - creation.nestedMemory;
+
+    if (!m_creations.isEmpty()) {
+        m_creations.last().nestedNsecs += nsecs;
+        m_creations.last().nestedMemory += memory;
+    }
+}
+
+void StartupTrace::watchFirstFrame(int screen, QQuickWindow *window)
+{
+    if (m_finished || m_firstFrames.contains(screen)) {
+        return;
+    }
+    m_watchedScreens.insert(screen);
+
+    auto connection = QSharedPointer<QMetaObject::Connection>::create();
+    // frameSwapped comes from the render thread, more of them may be queued before we disconnect
+    *connection = connect(window, &QQuickWindow::frameSwapped, this, [this, screen, connection]() {
+        QObject::disconnect(*connection);
+        firstFrameShown(screen);
+    }, Qt::QueuedConnection);
+}
+
+void StartupTrace::firstFrameShown(int screen)
+{
+    if (m_reported || m_firstFrames.contains(screen)) {
+        return;
+    }
+    m_firstFrames.insert(screen, m_clock.nsecsElapsed());
+
+    if (m_finished && m_firstFrames.count() >= m_watchedScreens.count()) {
+        writeReport();
+    }
+}
+
+void StartupTrace::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    m_creations.clear();
+
+    if (m_firstFrames.count() >= m_watchedScreens.count()) {
+        writeReport();
+    } else {
+        m_firstFramesTimeout.start();
+    }
+}
+
+void StartupTrace::writeReport()
+{
+    if (m_reported) {
+        return;
+    }
+    m_reported = true;
+    m_firstFramesTimeout.stop();
+
+    for (int screen : qAsConst(m_watchedScreens)) {
+        if (m_firstFrames.contains(screen)) {
+            qCInfo(PLASMASHELL) << "First frame on screen" << screen << "after" << toMsecs(m_firstFrames.value(screen)) << "ms";
+        } else {
+            qCInfo(PLASMASHELL) << "No frame on screen" << screen << "after" << s_firstFramesTimeout << "ms";
+        }
+    }
+
+    const QString traceFile = qEnvironmentVariable("PLASMA_STARTUP_TRACE");
+    if (traceFile.isEmpty()) {
+        return;
+    }
+
+    QFile file(traceFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(PLASMASHELL) << "Could not write the startup trace to" << traceFile << file.errorString();
+        return;
+    }
+    file.write(toJson());
+}
+
+QByteArray StartupTrace::toJson() const
+{
+    QJsonArray phases;
+    for (const PhaseTiming &phase : m_phases) {
+        phases.append(QJsonObject{
+            {QStringLiteral("name"), phase.name},
+            {QStringLiteral("start"), toMsecs(phase.start)},
+            {QStringLiteral("duration"), phase.duration < 0 ? -1 : toMsecs(phase.duration)}
+        });
+    }
+
+    // Most expensive first
+    QVector<QString> plugins;
+    plugins.reserve(m_costs.count());
+    for (auto it = m_costs.constBegin(); it != m_costs.constEnd(); ++it) {
+        plugins << it.key();
+    }
+    std::sort(plugins.begin(), plugins.end(), [this](const QString &a, const QString &b) {
+        return m_costs.value(a).nsecs > m_costs.value(b).nsecs;
+    });
+
+    QJsonArray costs;
+    for (const QString &plugin : qAsConst(plugins)) {
+        const PluginCost cost = m_costs.value(plugin);
+        costs.append(QJsonObject{
+            {QStringLiteral("plugin"), plugin},
+            {QStringLiteral("containment"), cost.containment},
+            {QStringLiteral("count"), cost.count},
+            {QStringLiteral("time"), toMsecs(cost.nsecs)},
+            {QStringLiteral("memory"), cost.memory / 1024}
+        });
+    }
+
+    QJsonArray firstFrames;
+    for (auto it = m_firstFrames.constBegin(); it != m_firstFrames.constEnd(); ++it) {
+        firstFrames.append(QJsonObject{
+            {QStringLiteral("screen"), it.key()},
+            {QStringLiteral("time"), toMsecs(it.value())}
+        });
+    }
+
+    const QJsonObject report{
+        {QStringLiteral("phases"), phases},
+        {QStringLiteral("plugins"), costs},
+        {QStringLiteral("firstFrames"), firstFrames}
+    };
+
+    return QJsonDocument(report).toJson();
+}
+
+qint64 StartupTrace::residentMemory()
+{
+#ifdef Q_OS_LINUX
+    // Second field of statm is the resident set size in pages
+    const int fd = ::open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+
+    char buffer[128];
+    const ssize_t length = ::read(fd, buffer, sizeof(buffer) - 1);
+    ::close(fd);
+    if (length <= 0) {
+        return 0;
+    }
+    buffer[length] = '\0';
+
+    const QList<QByteArray> fields = QByteArray(buffer, length).split(' ');
+    if (fields.count() < 2) {
+        return 0;
+    }
+
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,153 @@
+/*
+ *   Copyright 2026 agent <agent@local>
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Library General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+
+class QQuickWindow;
+
+/**
+ * Records where plasmashell spends its time while starting up.
+ *
+ * ShellCorona wraps its startup steps in phases. While a phase is running,
+ * every containment and applet that gets created is charged with the wall time
+ * and the resident memory growth from the moment the plugin loader is asked for
+ * it until the shell sees it added: this includes loading its package and
+ * restoring its configuration. Applets restored with a layout are only seen
+ * when their containment is added, each of them is charged until the next one
+ * starts. Creations nested in another one are not charged to it.
+ * The cost is accumulated per plugin id.
+ *
+ * The QML of applets is built later by the containment's view, its cost is
+ * part of the phases and of the first frame, not of any plugin.
+ *
+ * The report is available as JSON over D-Bus, and is written to the file named
+ * by the PLASMA_STARTUP_TRACE environment variable once all desktops are ready
+ * and have shown their first frame.
+ */
+class StartupTrace : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StartupTrace(QObject *parent = nullptr);
+    ~StartupTrace() override;
+
+    /**
+     * Phases can nest. Nothing is recorded once the trace is finished,
+     * begin returns whether the phase is being recorded
+     */
+    bool beginPhase(const QString &name);
+    void endPhase(const QString &name);
+
+    /**
+     * Called by the plugin loader when it starts creating the given plugin
+     */
+    void beginCreation(const QString &pluginId);
+
+    /**
+     * Charges the cost since the matching beginCreation to the given plugin.
+     * Does nothing outside of a phase
+     */
+    void endCreation(const QString &pluginId, bool containment);
+
+    /**
+     * Records the time of the first frame that window shows for the given screen id
+     */
+    void watchFirstFrame(int screen, QQuickWindow *window);
+
+    /**
+     * Stops recording. The report is logged and the trace file written as soon
+     * as every watched screen has shown its first frame, or after a timeout.
+     * Only the first call does anything
+     */
+    void finish();
+
+    QByteArray toJson() const;
+
+    class Phase
+    {
+    public:
+        Phase(StartupTrace *trace, const QString &name)
+            : m_trace(trace), m_name(name)
+        {
+            m_recording = m_trace->beginPhase(m_name);
+        }
+        ~Phase()
+        {
+            if (m_recording) {
+                m_trace->endPhase(m_name);
+            }
+        }
+
+    private:
+        Q_DISABLE_COPY(Phase)
+        StartupTrace *m_trace;
+        QString m_name;
+        bool m_recording;
+    };
+
+private:
+    struct PhaseTiming {
+        QString name;
+        qint64 start = 0;
+        qint64 duration = -1;
+    };
+
+    struct PluginCost {
+        bool containment = false;
+        int count = 0;
+        qint64 nsecs = 0;
+        qint64 memory = 0;
+    };
+
+    struct Creation {
+        QString pluginId;
+        qint64 start = 0;
+        qint64 startMemory = 0;
+        // spent in creations nested in this one
+        qint64 nestedNsecs = 0;
+        qint64 nestedMemory = 0;
+    };
+
+    void firstFrameShown(int screen);
+    void writeReport();
+    static qint64 residentMemory();
+
+    QElapsedTimer m_clock;
+    QVector<PhaseTiming> m_phases;
+    QHash<QString, PluginCost> m_costs;
+    QVector<Creation> m_creations;
+    QSet<int> m_watchedScreens;
+    QMap<int, qint64> m_firstFrames;
+    QTimer m_firstFramesTimeout;
+    int m_depth = 0;
+    bool m_finished = false;
+    bool m_reported = false;
+};
+
+#endif
@@ -20,21 +20,33 @@
 #include "statusnotifierwatcher.h"
 
 #include <QDBusConnection>
+#include <QDBusMetaType>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
 #include <QDBusServiceWatcher>
+#include <QDBusVariant>
 #include <QDebug>
 
 #include <kpluginfactory.h>
 
 #include "statusnotifierwatcheradaptor.h"
+#include "statusnotifieritemcacheadaptor.h"
 #include "statusnotifieritem_interface.h"
 
 K_PLUGIN_CLASS_WITH_JSON(StatusNotifierWatcher, "statusnotifierwatcher.json")
 
+// Hosts only learn about an item once its properties are fetched: a GetAll that failed,
+// typically timing out in the login burst, is retried after 1, 2, 4, 8 and 16 seconds
+static const int s_firstRetryInterval = 1000;
+static const int s_maxRetries = 5;
+
 StatusNotifierWatcher::StatusNotifierWatcher(QObject *parent, const QList<QVariant>&)
       : KDEDModule(parent)
 {
     setModuleName(QStringLiteral("StatusNotifierWatcher"));
+    qDBusRegisterMetaType<KDbusItemPropertiesMap>();
     new StatusNotifierWatcherAdaptor(this);
+    new StatusNotifierItemCacheAdaptor(this);
     QDBusConnection dbus = QDBusConnection::sessionBus();
     dbus.registerObject(QStringLiteral("/StatusNotifierWatcher"), this);
     dbus.registerService(QStringLiteral("org.kde.StatusNotifierWatcher"));
@@ -44,6 +56,16 @@ StatusNotifierWatcher::StatusNotifierWatcher(QObject *parent, const QList<QVaria
     m_serviceWatcher->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
 
     connect(m_serviceWatcher, &QDBusServiceWatcher::serviceUnregistered, this, &StatusNotifierWatcher::serviceUnregistered);
+
+    // Items registering at login or changing in bursts get fetched together
+    m_fetchTimer.setSingleShot(true);
+    m_fetchTimer.setInterval(50);
+    connect(&m_fetchTimer, &QTimer::timeout, this, &StatusNotifierWatcher::fetchChangedItems);
+
+    // Replies coming in together are handed to the hosts together
+    m_emitTimer.setSingleShot(true);
+    m_emitTimer.setInterval(10);
+    connect(&m_emitTimer, &QTimer::timeout, this, &StatusNotifierWatcher::emitChangedItems);
 }
 
 StatusNotifierWatcher::~StatusNotifierWatcher()
@@ -70,12 +92,15 @@ void StatusNotifierWatcher::RegisterStatusNotifierItem(const QString &serviceOrP
         qDebug()<<"Registering" << notifierItemId << "to system tray";
 
         //check if the service has registered a SystemTray object
-        org::kde::StatusNotifierItem trayclient(service, path,
-                                                QDBusConnection::sessionBus());
-        if (trayclient.isValid()) {
+        auto *trayclient = new org::kde::StatusNotifierItem(service, path,
+                                                            QDBusConnection::sessionBus(), this);
+        if (trayclient->isValid()) {
             m_registeredServices.append(notifierItemId);
             m_serviceWatcher->addWatchedService(service);
+            watchItem(notifierItemId, trayclient);
             emit StatusNotifierItemRegistered(notifierItemId);
+        } else {
+            delete trayclient;
         }
     }
 }
@@ -97,6 +122,13 @@ void StatusNotifierWatcher::serviceUnregistered(const QString& name)
         if (it->startsWith(match)) {
             QString name = *it;
             it = m_registeredServices.erase(it);
+
+            delete m_items.take(name);
+            m_itemProperties.remove(name);
+            m_changedProperties.remove(name);
+            m_changedItems.remove(name);
+            m_fetchRetries.remove(name);
+
             emit StatusNotifierItemUnregistered(name);
         } else {
             ++it;
@@ -132,4 +164,180 @@ int StatusNotifierWatcher::ProtocolVersion() const
     return 0;
 }
 
+KDbusItemPropertiesMap StatusNotifierWatcher::GetRegisteredItemsWithProperties() const
+{
+    return m_itemProperties;
+}
+
+void StatusNotifierWatcher::watchItem(const QString &notifierItemId, OrgKdeStatusNotifierItemInterface *item)
+{
+    m_items.insert(notifierItemId, item);
+
+    auto watch = [this, notifierItemId, item](void (OrgKdeStatusNotifierItemInterface::*signal)(), const QSet<QString> &properties) {
+        connect(item, signal, this, [this, notifierItemId, properties]() {
+            itemChanged(notifierItemId, properties);
+        });
+    };
+
+    watch(&OrgKdeStatusNotifierItemInterface::NewTitle, {QStringLiteral("Title")});
+    watch(&OrgKdeStatusNotifierItemInterface::NewIcon,
+          {QStringLiteral("IconThemePath"), QStringLiteral("IconName"), QStringLiteral("IconPixmap")});
+    watch(&OrgKdeStatusNotifierItemInterface::NewAttentionIcon,
+          {QStringLiteral("IconThemePath"), QStringLiteral("AttentionIconName"),
+           QStringLiteral("AttentionIconPixmap"), QStringLiteral("AttentionMovieName")});
+    watch(&OrgKdeStatusNotifierItemInterface::NewOverlayIcon,
+          {QStringLiteral("IconThemePath"), QStringLiteral("OverlayIconName"), QStringLiteral("OverlayIconPixmap")});
+    watch(&OrgKdeStatusNotifierItemInterface::NewToolTip, {QStringLiteral("ToolTip")});
+    connect(item, &OrgKdeStatusNotifierItemInterface::NewStatus, this, [this, notifierItemId]() {
+        itemChanged(notifierItemId, {QStringLiteral("Status")});
+    });
+
+    // New items get all their properties fetched
+    itemChanged(notifierItemId, QSet<QString>());
+}
+
+void StatusNotifierWatcher::itemChanged(const QString &notifierItemId, const QSet<QString> &properties)
+{
+    m_changedProperties[notifierItemId] += properties;
+
+    if (!m_fetchTimer.isActive()) {
+        m_fetchTimer.start();
+    }
+}
+
+void StatusNotifierWatcher::fetchChangedItems()
+{
+    auto it = m_changedProperties.begin();
+    while (it != m_changedProperties.end()) {
+        const QString notifierItemId = it.key();
+        // Waits for the fetch already running for this item
+        if (m_pendingFetches.contains(notifierItemId)) {
+            ++it;
+            continue;
+        }
+
+        OrgKdeStatusNotifierItemInterface *item = m_items.value(notifierItemId);
+        if (item) {
+            // New items get all their properties, known ones only the changed ones
+            if (!m_itemProperties.contains(notifierItemId)) {
+                fetchAllProperties(notifierItemId, item);
+            } else {
+                for (const QString &property : it.value()) {
+                    fetchProperty(notifierItemId, item, property);
+                }
+            }
+        }
+
+        it = m_changedProperties.erase(it);
+    }
+}
+
+void StatusNotifierWatcher::fetchAllProperties(const QString &notifierItemId, OrgKdeStatusNotifierItemInterface *item)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(item->service(), item->path(),
+                                                          QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("GetAll"));
+    message << item->interface();
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(item->connection().asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, notifierItemId](QDBusPendingCallWatcher *call) {
+        call->deleteLater();
+
+        QDBusPendingReply<QVariantMap> reply = *call;
+        if (reply.isError()) {
+            qDebug() << "Could not fetch the properties of" << notifierItemId << reply.error().message();
+            retryFetch(notifierItemId);
+        } else if (m_items.contains(notifierItemId)) {
+            m_fetchRetries.remove(notifierItemId);
+
+            const QVariantMap itemProperties = reply.argumentAt<0>();
+            m_itemProperties.insert(notifierItemId, itemProperties);
+
+            QVariantMap &changed = m_changedItems[notifierItemId];
+            for (auto it = itemProperties.constBegin(); it != itemProperties.constEnd(); ++it) {
+                changed.insert(it.key(), it.value());
+            }
+        }
+
+        fetchFinished(notifierItemId);
+    });
+    ++m_pendingFetches[notifierItemId];
+}
+
+void StatusNotifierWatcher::retryFetch(const QString &notifierItemId)
+{
+    if (!m_items.contains(notifierItemId)) {
+        return;
+    }
+
+    int &retries = m_fetchRetries[notifierItemId];
+    if (retries >= s_maxRetries) {
+        qWarning() << "Giving up fetching the properties of" << notifierItemId;
+        m_fetchRetries.remove(notifierItemId);
+        return;
+    }
+
+    const int interval = s_firstRetryInterval << retries;
+    ++retries;
+
+    QTimer::singleShot(interval, this, [this, notifierItemId]() {
+        // Only if it is still there and still unknown
+        if (m_items.contains(notifierItemId) && !m_itemProperties.contains(notifierItemId)) {
+            itemChanged(notifierItemId, QSet<QString>());
+        }
+    });
+}
+
+void StatusNotifierWatcher::fetchProperty(const QString &notifierItemId, OrgKdeStatusNotifierItemInterface *item, const QString &property)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(item->service(), item->path(),
+                                                          QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("Get"));
+    message << item->interface() << property;
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(item->connection().asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, notifierItemId, property](QDBusPendingCallWatcher *call) {
+        call->deleteLater();
+
+        QDBusPendingReply<QDBusVariant> reply = *call;
+        if (reply.isError()) {
+            // Optional properties are missing from some items
+            qDebug() << "Could not fetch" << property << "of" << notifierItemId << reply.error().message();
+        } else if (m_items.contains(notifierItemId)) {
+            const QVariant value = reply.argumentAt<0>().variant();
+            m_itemProperties[notifierItemId].insert(property, value);
+            m_changedItems[notifierItemId].insert(property, value);
+        }
+
+        fetchFinished(notifierItemId);
+    });
+    ++m_pendingFetches[notifierItemId];
+}
+
+void StatusNotifierWatcher::fetchFinished(const QString &notifierItemId)
+{
+    auto pending = m_pendingFetches.find(notifierItemId);
+    if (pending != m_pendingFetches.end() && --(*pending) > 0) {
+        return;
+    }
+    m_pendingFetches.remove(notifierItemId);
+
+    if (!m_changedItems.isEmpty() && !m_emitTimer.isActive()) {
+        m_emitTimer.start();
+    }
+
+    // The item changed again while it was being fetched
+    if (m_changedProperties.contains(notifierItemId) && !m_fetchTimer.isActive()) {
+        m_fetchTimer.start();
+    }
+}
+
+void StatusNotifierWatcher::emitChangedItems()
+{
+    if (m_changedItems.isEmpty()) {
+        return;
+    }
+
+    emit StatusNotifierItemsChanged(m_changedItems);
+    m_changedItems.clear();
+}
+
 #include "statusnotifierwatcher.moc"
@@ -23,11 +23,17 @@
 #include <kdedmodule.h>
 
 #include <QDBusContext>
+#include <QHash>
 #include <QObject>
 #include <QStringList>
 #include <QSet>
+#include <QTimer>
 
+#include "systemtraytypedefs.h"
+
+class QDBusPendingCallWatcher;
 class QDBusServiceWatcher;
+class OrgKdeStatusNotifierItemInterface;
 
 class StatusNotifierWatcher : public KDEDModule, protected QDBusContext
 {
@@ -51,6 +57,8 @@ public Q_SLOTS:
 
     void RegisterStatusNotifierHost(const QString &service);
 
+    KDbusItemPropertiesMap GetRegisteredItemsWithProperties() const;
+
 protected Q_SLOTS:
     void serviceUnregistered(const QString& name);
 
@@ -61,9 +69,35 @@ Q_SIGNALS:
     void StatusNotifierHostRegistered();
     void StatusNotifierHostUnregistered();
 
+    void StatusNotifierItemsChanged(const KDbusItemPropertiesMap &items);
+
 private:
+    void watchItem(const QString &notifierItemId, OrgKdeStatusNotifierItemInterface *item);
+    void itemChanged(const QString &notifierItemId, const QSet<QString> &properties);
+    void fetchChangedItems();
+    void fetchAllProperties(const QString &notifierItemId, OrgKdeStatusNotifierItemInterface *item);
+    void retryFetch(const QString &notifierItemId);
+    void fetchProperty(const QString &notifierItemId, OrgKdeStatusNotifierItemInterface *item, const QString &property);
+    void fetchFinished(const QString &notifierItemId);
+    void emitChangedItems();
+
     QDBusServiceWatcher *m_serviceWatcher = nullptr;
     QStringList m_registeredServices;
     QSet<QString> m_statusNotifierHostServices;
+
+    // Every host wants all properties of all items: fetch them once here and hand them
+    // out in one go, instead of each host asking each item
+    QHash<QString, OrgKdeStatusNotifierItemInterface *> m_items;
+    KDbusItemPropertiesMap m_itemProperties;
+    // Properties items told us about since the last fetch
+    QHash<QString, QSet<QString>> m_changedProperties;
+    KDbusItemPropertiesMap m_changedItems;
+    QTimer m_fetchTimer;
+    QTimer m_emitTimer;
+    // Calls still running for each item, an item is fetched again only once they all
+    // finished, without holding back the others
+    QHash<QString, int> m_pendingFetches;
+    // Failed attempts to fetch the properties of new items
+    QHash<QString, int> m_fetchRetries;
 };
 #endif
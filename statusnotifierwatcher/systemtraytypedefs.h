@@ -22,7 +22,9 @@
 #define SYSTEMTRAYTYPEDEFS_H
 
 #include <QByteArray>
+#include <QMap>
 #include <QString>
+#include <QVariantMap>
 #include <QVector>
 
 struct KDbusImageStruct {
@@ -40,9 +42,13 @@ struct KDbusToolTipStruct {
     QString subTitle;
 };
 
+// Properties of StatusNotifierItems by item id, as cached by the watcher
+typedef QMap<QString, QVariantMap> KDbusItemPropertiesMap;
+
 Q_DECLARE_METATYPE(KDbusImageStruct)
 Q_DECLARE_METATYPE(KDbusImageVector)
 Q_DECLARE_METATYPE(KDbusToolTipStruct)
+Q_DECLARE_METATYPE(KDbusItemPropertiesMap)
 
 #endif
 
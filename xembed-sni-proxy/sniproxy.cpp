@@ -21,6 +21,9 @@
 #include "sniproxy.h"
 
 #include <algorithm>
+#include <cstring>
+#include <sys/ipc.h>
+#include <sys/shm.h>
 #include <xcb/xcb.h>
 #include <xcb/xcb_atom.h>
 #include <xcb/xcb_event.h>
@@ -50,6 +53,7 @@
 #define SNI_WATCHER_PATH "/StatusNotifierWatcher"
 
 static uint16_t s_embedSize = 32; //max size of window to embed. We no longer resize the embedded window as Chromium acts stupidly.
+static const int s_minUpdateInterval = 100; //ms between two icon updates, animated icons damage their window constantly
 static unsigned int XEMBED_VERSION = 0;
 
 int SNIProxy::s_serviceCount = 0;
@@ -79,8 +83,16 @@ SNIProxy::SNIProxy(xcb_window_t wid, QObject* parent):
     //instead lets use one DBus connection per SNI
     m_dbus(QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("XembedSniProxy%1").arg(s_serviceCount++))),
     m_windowId(wid),
+    m_pixmapHash(0),
+    m_shmSegment(XCB_NONE),
+    m_shmId(-1),
+    m_shmData(nullptr),
+    m_updateTimer(new QTimer(this)),
     m_injectMode(Direct)
 {
+    m_updateTimer->setSingleShot(true);
+    connect(m_updateTimer, &QTimer::timeout, this, &SNIProxy::update);
+
     //create new SNI
     new StatusNotifierItemAdaptor(this);
     m_dbus.registerObject(QStringLiteral("/StatusNotifierItem"), this);
@@ -183,6 +195,8 @@ SNIProxy::SNIProxy(xcb_window_t wid, QObject* parent):
         m_injectMode = XTest;
     }
 
+    createShmSegment();
+
     //there's no damage event for the first paint, and sometimes it's not drawn immediately
     //not ideal, but it works better than nothing
     //test with xchat before changing
@@ -193,12 +207,94 @@ SNIProxy::~SNIProxy()
 {
     auto c = QX11Info::connection();
 
+    destroyShmSegment();
     xcb_destroy_window(c, m_containerWid);
     QDBusConnection::disconnectFromBus(m_dbus.name());
 }
 
+static bool sni_shm_available(xcb_connection_t *c)
+{
+    static int available = -1;
+
+    if (available == -1) {
+        const auto *extension = xcb_get_extension_data(c, &xcb_shm_id);
+        QScopedPointer<xcb_shm_query_version_reply_t, QScopedPointerPodDeleter> version;
+        if (extension && extension->present) {
+            version.reset(xcb_shm_query_version_reply(c, xcb_shm_query_version(c), nullptr));
+        }
+        available = version ? 1 : 0;
+    }
+
+    return available;
+}
+
+void SNIProxy::createShmSegment()
+{
+    auto c = QX11Info::connection();
+
+    if (!sni_shm_available(c)) {
+        return;
+    }
+
+    // The embedded window is never larger than s_embedSize, whatever its depth it fits in 32 bits per pixel
+    m_shmId = shmget(IPC_PRIVATE, s_embedSize * s_embedSize * 4, IPC_CREAT | 0600);
+    if (m_shmId < 0) {
+        return;
+    }
+
+    void *data = shmat(m_shmId, nullptr, 0);
+    if (data == reinterpret_cast<void *>(-1)) {
+        shmctl(m_shmId, IPC_RMID, nullptr);
+        m_shmId = -1;
+        return;
+    }
+    m_shmData = static_cast<quint8 *>(data);
+
+    m_shmSegment = xcb_generate_id(c);
+    // Fails for remote X servers, they can't see our memory
+    QScopedPointer<xcb_generic_error_t, QScopedPointerPodDeleter>
+        error(xcb_request_check(c, xcb_shm_attach_checked(c, m_shmSegment, m_shmId, false)));
+
+    // Once attached, the segment goes away when both of us detach it
+    shmctl(m_shmId, IPC_RMID, nullptr);
+
+    if (error) {
+        qCDebug(SNIPROXY) << "Could not attach a shared memory segment, capturing icons through the X connection";
+        m_shmSegment = XCB_NONE;
+        destroyShmSegment();
+    }
+}
+
+void SNIProxy::destroyShmSegment()
+{
+    if (m_shmSegment != XCB_NONE) {
+        xcb_shm_detach(QX11Info::connection(), m_shmSegment);
+        m_shmSegment = XCB_NONE;
+    }
+
+    if (m_shmData) {
+        shmdt(m_shmData);
+        m_shmData = nullptr;
+    }
+
+    m_shmId = -1;
+}
+
+void SNIProxy::scheduleUpdate()
+{
+    if (m_updateTimer->isActive()) {
+        return;
+    }
+
+    const qint64 elapsed = m_lastUpdate.isValid() ? m_lastUpdate.elapsed() : s_minUpdateInterval;
+    m_updateTimer->start(qMax<qint64>(0, s_minUpdateInterval - elapsed));
+}
+
 void SNIProxy::update()
 {
+    m_updateTimer->stop();
+    m_lastUpdate.start();
+
     const QImage image = getImageNonComposite();
     if (image.isNull()) {
         qCDebug(SNIPROXY) << "No xembed icon for" << m_windowId << Title();
@@ -208,11 +304,26 @@ void SNIProxy::update()
     int w = image.width();
     int h = image.height();
 
+    // Most damage doesn't change what the icon looks like, e.g. redraws of the same frame.
+    // The hash only rules out most changed frames quickly, a matching one is compared in full
+    const uint hash = qHashBits(image.constBits(), image.sizeInBytes(), uint(w) << 16 ^ uint(h) ^ image.format());
+    if (hash == m_pixmapHash && !m_pixmap.isNull()
+        && image.size() == m_lastFrame.size() && image.format() == m_lastFrame.format()
+        && image.bytesPerLine() == m_lastFrame.bytesPerLine()
+        && memcmp(image.constBits(), m_lastFrame.constBits(), image.sizeInBytes()) == 0) {
+        return;
+    }
+    m_pixmapHash = hash;
+    // The pixels may live in the shared memory segment, which the next capture overwrites
+    m_lastFrame = image.copy();
+
     m_pixmap = QPixmap::fromImage(image);
     if (w > s_embedSize || h > s_embedSize) {
         qCDebug(SNIPROXY) << "Scaling pixmap of window" << m_windowId << Title() << "from w*h" << w << h;
         m_pixmap = m_pixmap.scaled(s_embedSize, s_embedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
     }
+    // Serialized once here rather than for every client reading the property
+    m_iconPixmap = KDbusImageVector() << KDbusImageStruct(m_pixmap.toImage());
     emit NewIcon();
     emit NewToolTip();
 }
@@ -247,6 +358,11 @@ QSize SNIProxy::calculateClientWindowSize() const
     QScopedPointer<xcb_get_geometry_reply_t, QScopedPointerPodDeleter>
     clientGeom(xcb_get_geometry_reply(c, cookie, nullptr));
 
+    return normalizedClientWindowSize(clientGeom.data());
+}
+
+QSize SNIProxy::normalizedClientWindowSize(const xcb_get_geometry_reply_t *clientGeom) const
+{
     QSize clientWindowSize;
     if (clientGeom) {
         clientWindowSize = QSize(clientGeom->width, clientGeom->height);
@@ -281,6 +397,21 @@ bool SNIProxy::isTransparentImage(const QImage& image) const
 
     // skip scan altogether if sub-center pixel found to be opaque
     // and break out from the outer loop too on full scan
+    if (image.depth() == 32) {
+        // or the pixels of a line together without branching, so it gets vectorized
+        for (int y = 0; y < h; ++y) {
+            const quint32 *line = reinterpret_cast<const quint32 *>(image.constScanLine(y));
+            quint32 bits = 0;
+            for (int x = 0; x < w; ++x) {
+                bits |= line[x];
+            }
+            if (qAlpha(bits)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     for (int x = 0; x < w; ++x) {
         for (int y = 0; y < h; ++y) {
             if (qAlpha(image.pixel(x, y))) {
@@ -293,13 +424,80 @@ bool SNIProxy::isTransparentImage(const QImage& image) const
     return true;
 }
 
+SNIProxy::ImageCookie SNIProxy::requestImage(const QSize &size) const
+{
+    auto c = QX11Info::connection();
+
+    ImageCookie cookie;
+    cookie.size = size;
+    cookie.shm = m_shmSegment != XCB_NONE && size.width() <= s_embedSize && size.height() <= s_embedSize;
+
+    if (cookie.shm) {
+        cookie.sequence = xcb_shm_get_image(c, m_windowId, 0, 0, size.width(), size.height(), 0xFFFFFFFF,
+                                            XCB_IMAGE_FORMAT_Z_PIXMAP, m_shmSegment, 0).sequence;
+    } else {
+        cookie.sequence = xcb_get_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, m_windowId, 0, 0,
+                                        size.width(), size.height(), 0xFFFFFFFF).sequence;
+    }
+
+    return cookie;
+}
+
+xcb_image_t *SNIProxy::fetchImage(const ImageCookie &cookie) const
+{
+    auto c = QX11Info::connection();
+    const int width = cookie.size.width();
+    const int height = cookie.size.height();
+
+    if (cookie.shm) {
+        QScopedPointer<xcb_shm_get_image_reply_t, QScopedPointerPodDeleter>
+            reply(xcb_shm_get_image_reply(c, xcb_shm_get_image_cookie_t{cookie.sequence}, nullptr));
+        if (!reply) {
+            return nullptr;
+        }
+
+        // The image doesn't own the segment, its pixels are valid until the next capture
+        return xcb_image_create_native(c, width, height, XCB_IMAGE_FORMAT_Z_PIXMAP, reply->depth,
+                                       nullptr, reply->size, m_shmData);
+    }
+
+    xcb_get_image_reply_t *reply = xcb_get_image_reply(c, xcb_get_image_cookie_t{cookie.sequence}, nullptr);
+    if (!reply) {
+        return nullptr;
+    }
+
+    // Same as xcb_image_get: the image owns the reply and is backed by its data
+    xcb_image_t *image = xcb_image_create_native(c, width, height, XCB_IMAGE_FORMAT_Z_PIXMAP, reply->depth,
+                                                 reply, xcb_get_image_data_length(reply), xcb_get_image_data(reply));
+    if (!image) {
+        free(reply);
+    }
+    return image;
+}
+
 QImage SNIProxy::getImageNonComposite() const
 {
     auto c = QX11Info::connection();
 
-    QSize clientWindowSize = calculateClientWindowSize();
+    // The size of the window rarely changes: ask for its geometry and for the pixels
+    // at the size it had last time together, instead of waiting for one before the other
+    if (!m_clientWindowSize.isValid()) {
+        m_clientWindowSize = calculateClientWindowSize();
+    }
+    QSize clientWindowSize = m_clientWindowSize;
 
-    xcb_image_t *image = xcb_image_get(c, m_windowId, 0, 0, clientWindowSize.width(), clientWindowSize.height(), 0xFFFFFFFF, XCB_IMAGE_FORMAT_Z_PIXMAP);
+    auto geometryCookie = xcb_get_geometry(c, m_windowId);
+    ImageCookie imageCookie = requestImage(clientWindowSize);
+
+    QScopedPointer<xcb_get_geometry_reply_t, QScopedPointerPodDeleter>
+        clientGeom(xcb_get_geometry_reply(c, geometryCookie, nullptr));
+    m_clientWindowSize = normalizedClientWindowSize(clientGeom.data());
+
+    if (m_clientWindowSize != clientWindowSize) {
+        xcb_discard_reply(c, imageCookie.sequence);
+        imageCookie = requestImage(m_clientWindowSize);
+    }
+    xcb_image_t *image = fetchImage(imageCookie);
 
     // Don't hook up cleanup yet, we may use a different QImage after all
     QImage naiveConversion;
@@ -343,14 +541,13 @@ QImage SNIProxy::convertFromNative(xcb_image_t *xcbImage) const
         format = QImage::Format_RGB32;
         break;
     case 30: {
-        // Qt doesn't have a matching image format. We need to convert manually
+        // Qt doesn't have a matching image format. We need to convert manually,
+        // keeping the 8 most significant bits of each 10 bit channel
         quint32 *pixels = reinterpret_cast<quint32 *>(xcbImage->data);
-        for (uint i = 0; i < (xcbImage->size / 4); i++) {
-            int r = (pixels[i] >> 22) & 0xff;
-            int g = (pixels[i] >> 12) & 0xff;
-            int b = (pixels[i] >>  2) & 0xff;
-
-            pixels[i] = qRgba(r, g, b, 0xff);
+        const uint count = xcbImage->size / 4;
+        for (uint i = 0; i < count; i++) {
+            const quint32 pixel = pixels[i];
+            pixels[i] = 0xff000000 | ((pixel >> 6) & 0xff0000) | ((pixel >> 4) & 0xff00) | ((pixel >> 2) & 0xff);
         }
         // fall through, Qt format is still Format_ARGB32_Premultiplied
         Q_FALLTHROUGH();
@@ -451,8 +648,7 @@ QString SNIProxy::Id() const
 
 KDbusImageVector SNIProxy::IconPixmap() const
 {
-    KDbusImageStruct dbusImage(m_pixmap.toImage());
-    return KDbusImageVector() << dbusImage;
+    return m_iconPixmap;
 }
 
 bool SNIProxy::ItemIsMenu() const
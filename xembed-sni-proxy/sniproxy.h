@@ -25,14 +25,18 @@
 #include <QDBusArgument>
 #include <QDBusConnection>
 #include <QDBusObjectPath>
+#include <QElapsedTimer>
 #include <QPixmap>
 #include <QPoint>
 
 #include <xcb/xcb.h>
 #include <xcb/xcb_image.h>
+#include <xcb/shm.h>
 
 #include "snidbus.h"
 
+class QTimer;
+
 class SNIProxy : public QObject
 {
     Q_OBJECT
@@ -49,6 +53,11 @@ public:
     ~SNIProxy() override;
 
     void update();
+    /**
+     * Updates the icon soon, damage of animated icons is coalesced
+     * to a bounded amount of updates per second
+     */
+    void scheduleUpdate();
     void stackContainerWindow(const uint32_t stackMode) const;
     void resizeWindow(const uint16_t width, const uint16_t height) const;
 
@@ -148,7 +157,19 @@ private:
         XTest
     };
 
+    // A request for the pixels of the embedded window, read back with fetchImage()
+    struct ImageCookie {
+        unsigned int sequence;
+        QSize size;
+        bool shm;
+    };
+
+    void createShmSegment();
+    void destroyShmSegment();
+    ImageCookie requestImage(const QSize &size) const;
+    xcb_image_t *fetchImage(const ImageCookie &cookie) const;
     QSize calculateClientWindowSize() const;
+    QSize normalizedClientWindowSize(const xcb_get_geometry_reply_t *clientGeom) const;
     void sendClick(uint8_t mouseButton, int x, int y);
     QImage getImageNonComposite() const;
     bool isTransparentImage(const QImage &image) const;
@@ -160,6 +181,19 @@ private:
     xcb_window_t m_containerWid;
     static int s_serviceCount;
     QPixmap m_pixmap;
+    KDbusImageVector m_iconPixmap;
+    // The captured frame m_pixmap was made from, unscaled
+    QImage m_lastFrame;
+    uint m_pixmapHash;
+    mutable QSize m_clientWindowSize;
+
+    // Shared memory the X server copies the icon into, if MIT-SHM is usable
+    xcb_shm_seg_t m_shmSegment;
+    int m_shmId;
+    quint8 *m_shmData;
+
+    QTimer *m_updateTimer;
+    QElapsedTimer m_lastUpdate;
 
     InjectMode m_injectMode;
 };